@@ -1,14 +1,23 @@
 #include "TwitchLimiter.hpp"
 #include "eventsub.hpp"
+#include "logger.hpp"
 #include <obs.h>
 #include <obs-module.h>
 #include <obs-properties.h>
-#include <thread>
 #include <chrono>
+#include <cstdio>
 #include <string>
 
 constexpr size_t DEFAULT_MAX_BET_LIMIT = 5000UL;
 constexpr size_t DEFAULT_BET_TIMEOUT = 30UL;
+constexpr const char *DEFAULT_FANOUT_SESSION = "default";
+
+// Messages from the limiter core go to the OBS log
+static void log_to_obs(LogLevel level, const char *message)
+{
+	static constexpr int OBS_LEVELS[] = {LOG_ERROR, LOG_WARNING, LOG_INFO, LOG_DEBUG};
+	blog(OBS_LEVELS[static_cast<int>(level)], "%s", message);
+}
 
 // Implementation of the TwitchLimiter singleton
 TwitchLimiter &TwitchLimiter::instance(void)
@@ -20,11 +29,10 @@ TwitchLimiter &TwitchLimiter::instance(void)
 TwitchLimiter::TwitchLimiter(void)
 	: m_initialized(initialize()),
 	  m_custom_bet_limit_enabled(true),
-	  m_io_context(),
-	  m_reconnect_timer(m_io_context),
+	  m_overlay_mutex(),
+	  m_overlay_expiry(),
 	  m_overlay_source(nullptr, &obs_source_release)
 {
-	m_work_guard.emplace(m_io_context.get_executor());
 }
 
 TwitchLimiter::~TwitchLimiter(void)
@@ -36,6 +44,7 @@ TwitchLimiter::~TwitchLimiter(void)
 bool TwitchLimiter::initialize(void)
 {
 	blog(LOG_INFO, "Twitch Betting Limit Plugin Loaded.");
+	set_log_handler(log_to_obs); // before EventSub is first constructed
 	EventSub::instance().set_status_callback([this](bool connected) { update_websocket_status(connected); });
 
 	EventSub::instance().set_overlay_callback(
@@ -48,6 +57,7 @@ bool TwitchLimiter::initialize(void)
 void TwitchLimiter::shutdown(void)
 {
 	hide_overlay_notification();
+	EventSub::instance().set_webhook_endpoints(std::string_view()); // spills and joins the sink thread before unload
 	EventSub::instance().shutdown();
 }
 
@@ -73,6 +83,11 @@ obs_properties_t *TwitchLimiter::get_settings(void *data)
 	// Add integer properties.
 	obs_properties_add_int(props.get(), "max_bet_limit", "Max Bet Limit", 100, 100000, 100);
 	obs_properties_add_int(props.get(), "bet_timeout_duration", "Bet Timeout Duration (seconds)", 5, 300, 5);
+	obs_property_t *breach_cooldowns = obs_properties_add_bool(props.get(), "enable_breach_cooldowns",
+								   "Skip Overlay for Repeat Breaches");
+	obs_property_set_long_description(breach_cooldowns,
+					  "Once a user or a reward has shown the overlay, further breaches by that user "
+					  "or on that reward within the bet timeout are counted but not shown again.");
 
 	// Add button property for resetting bet limit.
 	obs_properties_add_button(props.get(), "reset_bet_limit", "Reset Bet Limit",
@@ -121,16 +136,79 @@ obs_properties_t *TwitchLimiter::get_settings(void *data)
 		obs_properties_add_text(props.get(), "ws_status", "WebSocket Status", OBS_TEXT_INFO);
 	obs_property_set_enabled(ws_status, false);
 
+	// Add properties for sharing one EventSub session between OBS instances on this host.
+	obs_property_t *fanout_mode = obs_properties_add_list(props.get(), "fanout_mode", "Shared Session Mode",
+							      OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(fanout_mode, "Standalone", static_cast<long long>(EventSub::FanoutMode::Standalone));
+	obs_property_list_add_int(fanout_mode, "Publisher (owns the connection)",
+				  static_cast<long long>(EventSub::FanoutMode::Publisher));
+	obs_property_list_add_int(fanout_mode, "Consumer (uses a publisher's connection)",
+				  static_cast<long long>(EventSub::FanoutMode::Consumer));
+	obs_properties_add_text(props.get(), "fanout_session", "Shared Session Name", OBS_TEXT_DEFAULT);
+
+	// Add text property for the overlay message.
+	obs_property_t *overlay_template =
+		obs_properties_add_text(props.get(), "overlay_template", "Overlay Message", OBS_TEXT_DEFAULT);
+	obs_property_set_long_description(overlay_template,
+					  "Placeholders: {user}, {amount}, {limit}, {reward}, {count} (breaches so far); "
+					  "use {{ and }} for literal braces. Empty shows \"Bet exceeds limit! Max: {limit}\".");
+
+	// Add text property for the outbound webhook endpoints.
+	obs_property_t *webhook_urls =
+		obs_properties_add_text(props.get(), "webhook_urls", "Webhook URLs", OBS_TEXT_DEFAULT);
+	obs_property_set_long_description(webhook_urls,
+					  "Comma separated http:// URLs. Redemptions and breaches are POSTed to each as "
+					  "NDJSON batches; while an endpoint is down its events are kept on disk.");
+	obs_property_t *webhook_remote = obs_properties_add_bool(props.get(), "webhook_allow_remote",
+								 "Allow Webhooks to Other Hosts (unencrypted)");
+	obs_property_set_long_description(webhook_remote,
+					  "Off: only URLs on this machine (localhost, 127.0.0.1 or [::1]) are used. "
+					  "Events are sent as plain HTTP, so enable this only on a network you trust.");
+
+	// Add properties for the adaptive limit controller and its current decision.
+	obs_properties_add_bool(props.get(), "enable_adaptive_limit", "Tighten Bet Limit During Bursts");
+	obs_properties_add_int(props.get(), "adaptive_tighten_percent", "Tightened Limit (% of Max Bet Limit)", 10, 100,
+			       5);
+	obs_property_t *adaptive_status = obs_properties_add_text(props.get(), "adaptive_limit_status",
+								  adaptive_limit_status().c_str(), OBS_TEXT_INFO);
+	obs_property_set_long_description(adaptive_status,
+					  "Redemption rate and cost are compared against their running baseline; "
+					  "a sustained burst tightens the limit until traffic is back to normal.");
+	obs_properties_add_button(props.get(), "refresh_adaptive_limit_status", "Refresh Adaptive Limit Status",
+				  [](obs_properties_t *props, obs_property_t *prop, void *data) -> bool {
+					  (void)prop;
+					  (void)data;
+					  // OBS redraws the existing properties, so the label itself has to change
+					  obs_property_set_description(
+						  obs_properties_get(props, "adaptive_limit_status"),
+						  TwitchLimiter::instance().adaptive_limit_status().c_str());
+					  return true;
+				  });
+
+	// Add properties for the optional localhost Prometheus endpoint.
+	obs_properties_add_bool(props.get(), "enable_metrics_endpoint", "Enable Metrics Endpoint (localhost)");
+	obs_properties_add_int(props.get(), "metrics_port", "Metrics Port", 1024, 65535, 1);
+
 	return props.release();
 }
 
+// Sliders show their minimum for an unset value, so every setting whose runtime default differs needs one here
+void TwitchLimiter::get_defaults(obs_data_t *settings)
+{
+	obs_data_set_default_int(settings, "adaptive_tighten_percent",
+				 static_cast<long long>(AdaptiveLimit::DEFAULT_TIGHTEN_PERCENT));
+	obs_data_set_default_int(settings, "metrics_port", static_cast<long long>(MetricsServer::DEFAULT_PORT));
+}
+
 void TwitchLimiter::update_settings(obs_data_t *settings)
 {
+	get_defaults(settings);
 	m_custom_bet_limit_enabled.store(obs_data_get_bool(settings, "enable_custom_bet_limit"));
 	EventSub::instance().set_max_bet_limit(m_custom_bet_limit_enabled.load(),
 					       static_cast<size_t>(obs_data_get_int(settings, "max_bet_limit")));
 	EventSub::instance().set_bet_timeout_duration(
 		static_cast<size_t>(obs_data_get_int(settings, "bet_timeout_duration")));
+	EventSub::instance().set_breach_cooldowns(obs_data_get_bool(settings, "enable_breach_cooldowns"));
 
 	const char *new_url = obs_data_get_string(settings, "websocket_url");
 	if (new_url && *new_url) {
@@ -139,6 +217,21 @@ void TwitchLimiter::update_settings(obs_data_t *settings)
 		EventSub::instance().set_websocket_url();
 	}
 
+	EventSub::instance().set_metrics_endpoint(obs_data_get_bool(settings, "enable_metrics_endpoint"),
+						  static_cast<size_t>(obs_data_get_int(settings, "metrics_port")));
+
+	EventSub::instance().set_adaptive_limit(obs_data_get_bool(settings, "enable_adaptive_limit"),
+						static_cast<size_t>(obs_data_get_int(settings, "adaptive_tighten_percent")));
+
+	EventSub::instance().set_overlay_template(obs_data_get_string(settings, "overlay_template"));
+	EventSub::instance().set_webhook_endpoints(obs_data_get_string(settings, "webhook_urls"),
+						   obs_data_get_bool(settings, "webhook_allow_remote"));
+
+	const char *fanout_session = obs_data_get_string(settings, "fanout_session");
+	EventSub::instance().set_fanout_mode(
+		static_cast<EventSub::FanoutMode>(obs_data_get_int(settings, "fanout_mode")),
+		(fanout_session && *fanout_session) ? fanout_session : DEFAULT_FANOUT_SESSION);
+
 	blog(LOG_INFO, "Updated WebSocket URL: %s", EventSub::instance().get_websocket_url().c_str());
 	blog(LOG_INFO, "Updated Bet Limit: %s",
 	     m_custom_bet_limit_enabled.load() ? std::to_string(EventSub::instance().get_max_bet_limit()).c_str()
@@ -220,29 +313,67 @@ bool TwitchLimiter::reset_overlay(obs_properties_t *props, obs_property_t *prop,
 	return true;
 }
 
+// Called on the EventSub io thread through the overlay callback
 void TwitchLimiter::show_overlay_notification(std::string_view message, size_t duration)
 {
 	std::unique_ptr<obs_data_t, decltype(&obs_data_release)> settings(obs_data_create(), &obs_data_release);
-	obs_data_set_string(settings.get(), "text", message.data());
+	obs_data_set_string(settings.get(), "text", std::string(message).c_str());
 
+	std::lock_guard<std::mutex> lock(m_overlay_mutex);
 	if (!m_overlay_source) {
 		m_overlay_source.reset(obs_source_create("text_gdiplus", "Bet Limit Warning", settings.get(), nullptr));
 	} else {
 		obs_source_update(m_overlay_source.get(), settings.get());
 	}
 
-	// Set timer to auto-hide overlay
-	m_reconnect_timer.expires_after(std::chrono::seconds(duration));
-	m_reconnect_timer.async_wait([this](const boost::system::error_code &) { this->hide_overlay_notification(); });
-
-	// Start Boost.Asio event loop in background
-	std::thread([this]() { m_io_context.run(); }).detach();
+	// Auto-hide through the shared timing wheel; a newer breach replaces the pending expiry
+	EventSub::instance().cancel_timeout(m_overlay_expiry);
+	m_overlay_expiry = EventSub::instance().schedule_timeout(std::chrono::seconds(duration),
+								 [this]() { this->hide_overlay_notification(); });
 }
 
 void TwitchLimiter::hide_overlay_notification(void)
 {
-	m_work_guard.reset(); // Smart pointer handles cleanup
-	m_reconnect_timer.cancel();
+	std::lock_guard<std::mutex> lock(m_overlay_mutex);
+	EventSub::instance().cancel_timeout(m_overlay_expiry);
+	m_overlay_expiry = TimingWheel::Handle{};
+
+	if (m_overlay_source) {
+		std::unique_ptr<obs_data_t, decltype(&obs_data_release)> settings(obs_data_create(),
+										  &obs_data_release);
+		obs_data_set_string(settings.get(), "text", "");
+		obs_source_update(m_overlay_source.get(), settings.get());
+	}
+}
+
+std::string TwitchLimiter::adaptive_limit_status(void) const
+{
+	const AdaptiveLimit::Status status = EventSub::instance().get_adaptive_limit_status();
+	if (!status.enabled) {
+		return "Adaptive Limit: Off";
+	}
+	char text[256];
+	if (status.warming_up) {
+		std::snprintf(text, sizeof(text), "Adaptive Limit: Learning normal traffic (%llu of %llu bets)...",
+			      static_cast<unsigned long long>(status.samples),
+			      static_cast<unsigned long long>(AdaptiveLimit::WARMUP_SAMPLES));
+		return text;
+	}
+
+	const long long since = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() -
+										    status.changed_at)
+					.count();
+	if (status.tightened) {
+		std::snprintf(text, sizeof(text),
+			      "Adaptive Limit: Tightened to %zu for %lld s (%s burst, %.2f/s vs %.2f/s normal)",
+			      status.effective_limit, since,
+			      status.reason == AdaptiveLimit::Reason::Rate ? "rate" : "cost", status.rate,
+			      status.rate_baseline);
+	} else {
+		std::snprintf(text, sizeof(text), "Adaptive Limit: Normal, %zu (%.2f/s, %llu tightenings so far)",
+			      status.effective_limit, status.rate, static_cast<unsigned long long>(status.tightenings));
+	}
+	return text;
 }
 
 void TwitchLimiter::update_websocket_status(bool connected) const
@@ -1,15 +1,14 @@
 #pragma once
 
 #include <obs-module.h>
+#include <string>
 #include <string_view>
 #include <cstddef>
 #include <atomic>
-#include <optional>
 #include <memory>
+#include <mutex>
 
-#include <boost/asio.hpp>
-#include <boost/asio/steady_timer.hpp>
-#include <boost/asio/executor_work_guard.hpp>
+#include "timing_wheel.hpp"
 
 class TwitchLimiter {
 public:
@@ -20,6 +19,7 @@ public:
 	void shutdown(void);
 	bool initialized(void) const;
 	obs_properties_t *get_settings(void *data);
+	void get_defaults(obs_data_t *settings);
 	void update_settings(obs_data_t *settings);
 
 	// OBS UI callback implementations
@@ -35,6 +35,7 @@ public:
 	void hide_overlay_notification(void);
 
 	void update_websocket_status(bool connected) const;
+	std::string adaptive_limit_status(void) const;
 
 protected:
 	TwitchLimiter(void);
@@ -50,8 +51,7 @@ private:
 	// Member variables for settings, overlay, etc.
 	const bool m_initialized;
 	std::atomic<bool> m_custom_bet_limit_enabled;
-	boost::asio::io_context m_io_context;
-	boost::asio::steady_timer m_reconnect_timer;
-	std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> m_work_guard;
+	std::mutex m_overlay_mutex;
+	TimingWheel::Handle m_overlay_expiry;
 	std::unique_ptr<obs_source_t, decltype(&obs_source_release)> m_overlay_source;
 };
@@ -18,6 +18,11 @@ obs_properties_t *TwitchLimiter_get_settings(void *data)
 	return TwitchLimiter::instance().get_settings(data);
 }
 
+void TwitchLimiter_get_defaults(obs_data_t *settings)
+{
+	TwitchLimiter::instance().get_defaults(settings);
+}
+
 void TwitchLimiter_update_settings(obs_data_t *settings)
 {
 	TwitchLimiter::instance().update_settings(settings);
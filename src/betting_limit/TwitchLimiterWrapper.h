@@ -9,6 +9,7 @@ extern "C" {
 bool TwitchLimiter_load(void);
 void TwitchLimiter_unload(void);
 obs_properties_t *TwitchLimiter_get_settings(void *data);
+void TwitchLimiter_get_defaults(obs_data_t *settings);
 void TwitchLimiter_update_settings(obs_data_t *settings);
 
 #ifdef __cplusplus
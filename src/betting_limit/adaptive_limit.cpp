@@ -0,0 +1,247 @@
+#include "adaptive_limit.hpp"
+#include "metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "logger.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr double RATE_TIME_CONSTANT = 10.0;      // seconds; the "current" redemption rate
+constexpr double BASELINE_TIME_CONSTANT = 600.0; // seconds; the "normal" rate and cost
+constexpr double MIN_DEVIATION_FRACTION = 0.1;   // floor for the standard deviation, relative to the mean
+constexpr double BASELINE_WINSOR_Z = 3.0;        // samples are clipped to this many deviations before learning
+constexpr double RATE_ENTER_Z = 5.0;             // tighten when the current rate is this far above normal...
+constexpr double RATE_ENTER_RATIO = 2.0;         // ...at least this many times the normal rate...
+constexpr double RATE_ENTER_BETS = 10.0;         // ...and at least this many bets within RATE_TIME_CONSTANT
+constexpr double RATE_EXIT_Z = 1.0;              // relax below this (hysteresis)
+constexpr double COST_Z_CLAMP = 4.0;             // one outlier cannot trip the cost CUSUM on its own
+constexpr double CUSUM_DRIFT = 1.0;              // z-score slack per bet before evidence accumulates
+constexpr double CUSUM_ENTER = 8.0;              // tighten above this
+constexpr double CUSUM_EXIT = 1.0;               // relax below this (hysteresis)
+constexpr double CUSUM_CEILING = 16.0;           // a longer burst adds no evidence, only a longer recovery
+constexpr auto MIN_HOLD = std::chrono::seconds(30);
+//--------------------------------------------------------------
+static_assert(std::atomic<double>::is_always_lock_free, "status snapshots must not take locks");
+
+static const char *reason_name(AdaptiveLimit::Reason reason)
+{
+	switch (reason) {
+	case AdaptiveLimit::Reason::Rate:
+		return "redemption rate";
+	case AdaptiveLimit::Reason::Cost:
+		return "redemption cost";
+	default:
+		return "none";
+	}
+}
+//--------------------------------------------------------------
+// **🔹 Constructor**
+AdaptiveLimit::AdaptiveLimit(void)
+	: m_enabled(false),
+	  m_tightened(false),
+	  m_tighten_percent(DEFAULT_TIGHTEN_PERCENT),
+	  m_effective_limit(std::numeric_limits<size_t>::max()),
+	  m_tightenings(0UL),
+	  m_observed(0UL),
+	  m_reason(Reason::None),
+	  m_rate(0.0),
+	  m_rate_baseline(0.0),
+	  m_changed_at(0)
+{
+	reset();
+}
+
+// **🔹 Configuration**
+void AdaptiveLimit::configure(bool enable, size_t tighten_percent)
+{
+	m_tighten_percent.store(std::clamp<size_t>(tighten_percent, 1UL, 100UL));
+	if (enable == m_enabled.load()) {
+		return;
+	}
+
+	// Toggling starts over: a stale baseline would judge the first bets against old traffic
+	reset();
+	m_enabled.store(enable);
+	log_message(LogLevel::Info, "Adaptive bet limit %s", enable ? "enabled" : "disabled");
+}
+
+bool AdaptiveLimit::enabled(void) const
+{
+	return m_enabled.load(std::memory_order_relaxed);
+}
+
+// **🔹 Per-Bet Update (hot path)**
+size_t AdaptiveLimit::observe(size_t cost, size_t base_limit, Clock::time_point now)
+{
+	if (!enabled() or base_limit == std::numeric_limits<size_t>::max()) {
+		return base_limit;
+	}
+
+	// Exponentially decayed event count / time constant = events per second, in O(1)
+	const double elapsed =
+		m_samples == 0UL ? 0.0 : std::max(std::chrono::duration<double>(now - m_last_event).count(), 0.0);
+	const double rate_elapsed =
+		m_samples == 0UL ? 0.0 : std::max(std::chrono::duration<double>(now - m_rate_time).count(), 0.0);
+	const double rate = m_rate.load(std::memory_order_relaxed) * std::exp(-rate_elapsed / RATE_TIME_CONSTANT) +
+			    1.0 / RATE_TIME_CONSTANT;
+	const double log_cost = std::log1p(static_cast<double>(cost)); // costs are heavy-tailed
+	m_last_event = now;
+	m_rate_time = now;
+	++m_samples;
+	m_observed.store(m_samples, std::memory_order_relaxed);
+
+	bool tightened = m_tightened.load(std::memory_order_relaxed);
+	if (m_samples > WARMUP_SAMPLES) {
+		// The decayed rate already averages ~RATE_TIME_CONSTANT seconds, so it is thresholded directly;
+		// per-bet costs are independent samples and go through a CUSUM instead
+		const double rate_z = z_score(m_rate_estimate, rate);
+		const double cost_z = std::clamp(z_score(m_cost_estimate, log_cost), -COST_Z_CLAMP, COST_Z_CLAMP);
+		m_cost_cusum = std::clamp(m_cost_cusum + cost_z - CUSUM_DRIFT, 0.0, CUSUM_CEILING);
+
+		const bool rate_burst = rate_z > RATE_ENTER_Z and rate > RATE_ENTER_RATIO * m_rate_estimate.mean and
+					rate * RATE_TIME_CONSTANT >= RATE_ENTER_BETS;
+		const bool cost_burst = m_cost_cusum > CUSUM_ENTER;
+		if (!tightened and (rate_burst or cost_burst)) {
+			const Reason reason = rate_burst ? Reason::Rate : Reason::Cost;
+			tightened = true;
+			m_reason.store(reason, std::memory_order_relaxed);
+			m_changed_at.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+			m_tightenings.fetch_add(1UL, std::memory_order_relaxed);
+			Metrics::instance().increment(Metrics::Counter::LimitTightenings);
+			log_message(LogLevel::Info,
+				    "Adaptive bet limit tightened to %zu%% (burst in %s: %.2f/s vs %.2f/s normal)",
+				    m_tighten_percent.load(), reason_name(reason), rate, m_rate_estimate.mean);
+		} else if (tightened and rate_z < RATE_EXIT_Z and m_cost_cusum < CUSUM_EXIT and hold_passed(now)) {
+			tightened = false;
+			relax(rate, now);
+		}
+	}
+
+	// The baseline only learns from normal traffic. Weighting by elapsed time rather than per bet
+	// keeps its memory at ~BASELINE_TIME_CONSTANT whatever the channel's volume; the first bets are
+	// averaged exactly until that takes over.
+	if (!tightened) {
+		const double alpha = std::max(1.0 - std::exp(-elapsed / BASELINE_TIME_CONSTANT),
+					      1.0 / static_cast<double>(m_samples));
+		update_baseline(m_rate_estimate, rate, alpha);
+		update_baseline(m_cost_estimate, log_cost, alpha);
+	}
+
+	const size_t limit =
+		tightened ? tightened_limit(base_limit, m_tighten_percent.load(std::memory_order_relaxed)) : base_limit;
+
+	m_tightened.store(tightened, std::memory_order_relaxed);
+	m_rate.store(rate, std::memory_order_relaxed);
+	m_rate_baseline.store(m_rate_estimate.mean, std::memory_order_relaxed);
+	m_effective_limit.store(limit, std::memory_order_relaxed);
+	return limit;
+}
+
+// **🔹 Idle Decay**
+// With no bets the rate estimate keeps decaying, and every bet that would have arrived at the normal
+// rate counts as one at the normal cost, taking CUSUM_DRIFT off the cost evidence
+bool AdaptiveLimit::decay(size_t base_limit, Clock::time_point now)
+{
+	if (!enabled() or !tightened()) {
+		return false;
+	}
+
+	const double rate_elapsed = std::max(std::chrono::duration<double>(now - m_rate_time).count(), 0.0);
+	const double idle = std::max(std::chrono::duration<double>(now - m_last_event).count(), 0.0);
+	const double rate = m_rate.load(std::memory_order_relaxed) * std::exp(-rate_elapsed / RATE_TIME_CONSTANT);
+	const double cusum = std::max(0.0, m_cost_cusum - CUSUM_DRIFT * m_rate_estimate.mean * idle);
+	m_rate.store(rate, std::memory_order_relaxed);
+	m_rate_time = now;
+
+	if (z_score(m_rate_estimate, rate) >= RATE_EXIT_Z or cusum >= CUSUM_EXIT or !hold_passed(now)) {
+		return true;
+	}
+
+	m_cost_cusum = cusum;
+	relax(rate, now);
+	m_tightened.store(false, std::memory_order_relaxed);
+	m_effective_limit.store(base_limit, std::memory_order_relaxed);
+	return false;
+}
+
+bool AdaptiveLimit::tightened(void) const
+{
+	return m_tightened.load(std::memory_order_relaxed);
+}
+
+size_t AdaptiveLimit::tightened_limit(size_t base_limit, size_t tighten_percent)
+{
+	const double limit = static_cast<double>(base_limit) * static_cast<double>(tighten_percent) / 100.0;
+	return std::max<size_t>(static_cast<size_t>(limit), 1UL);
+}
+
+bool AdaptiveLimit::hold_passed(Clock::time_point now) const
+{
+	return now - Clock::time_point(Clock::duration(m_changed_at.load(std::memory_order_relaxed))) >= MIN_HOLD;
+}
+
+void AdaptiveLimit::relax(double rate, Clock::time_point now)
+{
+	m_reason.store(Reason::None, std::memory_order_relaxed);
+	m_changed_at.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+	log_message(LogLevel::Info, "Adaptive bet limit relaxed (%.2f/s vs %.2f/s normal)", rate,
+		    m_rate_estimate.mean);
+}
+
+AdaptiveLimit::Status AdaptiveLimit::status(void) const
+{
+	const uint64_t samples = m_observed.load();
+	return Status{m_enabled.load(),
+		      samples <= WARMUP_SAMPLES,
+		      samples,
+		      m_tightened.load(),
+		      m_reason.load(),
+		      m_effective_limit.load(),
+		      m_tightenings.load(),
+		      m_rate.load(),
+		      m_rate_baseline.load(),
+		      Clock::time_point(Clock::duration(m_changed_at.load()))};
+}
+
+// **🔹 Streaming Estimates**
+double AdaptiveLimit::deviation(const Estimate &estimate)
+{
+	return std::max({std::sqrt(estimate.variance), MIN_DEVIATION_FRACTION * std::abs(estimate.mean),
+			 std::numeric_limits<double>::epsilon()});
+}
+
+double AdaptiveLimit::z_score(const Estimate &estimate, double value)
+{
+	return (value - estimate.mean) / deviation(estimate);
+}
+
+// Exponentially weighted mean and variance. After the warm-up, samples are winsorized so the
+// ramp of a burst cannot inflate the variance it is judged by.
+void AdaptiveLimit::update_baseline(Estimate &estimate, double value, double alpha) const
+{
+	if (m_samples > WARMUP_SAMPLES) {
+		const double z = std::clamp(z_score(estimate, value), -BASELINE_WINSOR_Z, BASELINE_WINSOR_Z);
+		value = estimate.mean + z * deviation(estimate);
+	}
+
+	const double delta = value - estimate.mean;
+	estimate.mean += alpha * delta;
+	estimate.variance = (1.0 - alpha) * (estimate.variance + alpha * delta * delta);
+}
+
+void AdaptiveLimit::reset(void)
+{
+	m_samples = 0UL;
+	m_observed.store(0UL);
+	m_last_event = Clock::time_point();
+	m_rate_time = Clock::time_point();
+	m_rate_estimate = Estimate{0.0, 0.0};
+	m_cost_estimate = Estimate{0.0, 0.0};
+	m_cost_cusum = 0.0;
+	m_tightened.store(false);
+	m_reason.store(Reason::None);
+	m_rate.store(0.0);
+	m_rate_baseline.store(0.0);
+	m_effective_limit.store(std::numeric_limits<size_t>::max());
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+
+// Optional controller that tightens the bet limit during bursts (raids, bet storms).
+// Every bet feeds O(1) streaming estimates: a time-decayed redemption rate and the log
+// cost, each compared against a slow EWMA baseline with its variance. A rate z-score
+// over the upper threshold, or a one-sided CUSUM of cost z-scores over its threshold,
+// tightens the limit; it is only relaxed once both are back under their lower
+// thresholds and the minimum hold has passed (hysteresis). The baseline is frozen while tightened so a
+// long burst does not become the new normal. `configure` and `observe` run on the
+// EventSub io thread; `status()` may be read from any thread.
+class AdaptiveLimit {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	enum class Reason : uint8_t { None, Rate, Cost };
+
+	static constexpr size_t DEFAULT_TIGHTEN_PERCENT = 50UL;
+	static constexpr uint64_t WARMUP_SAMPLES = 50UL; // no decisions until the baseline has seen this many bets
+	static constexpr auto DECAY_INTERVAL = std::chrono::seconds(5); // `decay` re-check period while tightened
+
+	struct Status {
+		bool enabled;
+		bool warming_up; // still learning the baseline: nothing is tightened yet
+		uint64_t samples; // bets seen since enabled
+		bool tightened;
+		Reason reason;
+		size_t effective_limit;
+		uint64_t tightenings;
+		double rate, rate_baseline; // redemptions per second
+		Clock::time_point changed_at;
+	};
+
+	AdaptiveLimit(void);
+
+	void configure(bool enable, size_t tighten_percent);
+	bool enabled(void) const;
+
+	// Feeds one bet (`cost` is the newly spent amount) and returns the limit to apply to it
+	size_t observe(size_t cost, size_t base_limit, Clock::time_point now);
+
+	// Re-checks a tightened limit without a bet, so it relaxes once traffic stops after a burst
+	// instead of waiting for the next bet; returns true while still tightened
+	bool decay(size_t base_limit, Clock::time_point now);
+	bool tightened(void) const;
+
+	// The limit applied while tightened, never below 1
+	static size_t tightened_limit(size_t base_limit, size_t tighten_percent);
+
+	Status status(void) const;
+
+private:
+	struct Estimate {
+		double mean, variance;
+	};
+
+	static double deviation(const Estimate &estimate);
+	static double z_score(const Estimate &estimate, double value);
+	void update_baseline(Estimate &estimate, double value, double alpha) const;
+	bool hold_passed(Clock::time_point now) const;
+	void relax(double rate, Clock::time_point now);
+	void reset(void);
+
+	std::atomic<bool> m_enabled, m_tightened;
+	std::atomic<size_t> m_tighten_percent, m_effective_limit;
+	std::atomic<uint64_t> m_tightenings, m_observed;
+	std::atomic<Reason> m_reason;
+	std::atomic<double> m_rate, m_rate_baseline;
+	std::atomic<Clock::rep> m_changed_at;
+
+	// io-thread state
+	uint64_t m_samples;
+	Clock::time_point m_last_event, m_rate_time; // last bet; last time `m_rate` was brought up to date
+	Estimate m_rate_estimate, m_cost_estimate;
+	double m_cost_cusum;
+};
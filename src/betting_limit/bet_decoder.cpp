@@ -0,0 +1,118 @@
+#include "bet_decoder.hpp"
+#include "eventsub_json.hpp"
+#include "perfect_hash.hpp"
+#include "logger.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr std::string_view EVENTSUB_BET_EVENT = "channel.channel_points_custom_reward_redemption.add";
+constexpr std::string_view EVENTSUB_PREDICTION_BEGIN = "channel.prediction.begin";
+constexpr std::string_view EVENTSUB_PREDICTION_PROGRESS = "channel.prediction.progress";
+constexpr std::string_view EVENTSUB_PREDICTION_LOCK = "channel.prediction.lock";
+constexpr std::string_view EVENTSUB_PREDICTION_END = "channel.prediction.end";
+//--------------------------------------------------------------
+// **🔹 Constructor**
+BetDecoder::BetDecoder(void) : m_prediction_pool() {}
+
+// **🔹 Dispatch**
+const BetDecoder::Decoder *BetDecoder::route(std::string_view subscription_type)
+{
+	static constexpr auto SUBSCRIPTION_ROUTES = make_perfect_hash_table<Decoder>({
+		{EVENTSUB_BET_EVENT, &BetDecoder::decode_redemption},
+		{EVENTSUB_PREDICTION_BEGIN, &BetDecoder::decode_prediction<PredictionPhase::Begin>},
+		{EVENTSUB_PREDICTION_PROGRESS, &BetDecoder::decode_prediction<PredictionPhase::Progress>},
+		{EVENTSUB_PREDICTION_LOCK, &BetDecoder::decode_prediction<PredictionPhase::Lock>},
+		{EVENTSUB_PREDICTION_END, &BetDecoder::decode_prediction<PredictionPhase::End>},
+	});
+	return SUBSCRIPTION_ROUTES.find(subscription_type);
+}
+
+BetDecoder::Result BetDecoder::decode(std::string_view subscription_type, const rapidjson::Value &event,
+				      const BetHandler &handler)
+{
+	const Decoder *decoder = route(subscription_type);
+	return decoder ? (this->*(*decoder))(event, handler) : Result::Ignored;
+}
+
+bool BetDecoder::order_dependent(std::string_view subscription_type)
+{
+	const Decoder *decoder = route(subscription_type);
+	return decoder and *decoder != &BetDecoder::decode_redemption;
+}
+
+const PredictionPool &BetDecoder::prediction_pool(void) const
+{
+	return m_prediction_pool;
+}
+
+// **🔹 Channel Points Redemption**
+BetDecoder::Result BetDecoder::decode_redemption(const rapidjson::Value &event, const BetHandler &handler)
+{
+	const rapidjson::Value *reward = json_object(event, "reward");
+	if (!reward or !reward->HasMember("cost") or !(*reward)["cost"].IsUint()) {
+		return Result::Invalid;
+	}
+
+	handler(Bet{Source::Redemption, (*reward)["cost"].GetUint(), 0UL, json_string(event, "user_id"),
+		    json_string(event, "user_name"), json_string(*reward, "title")});
+	return Result::Decoded;
+}
+
+// **🔹 Channel Prediction**
+template<BetDecoder::PredictionPhase Phase>
+BetDecoder::Result BetDecoder::decode_prediction(const rapidjson::Value &event, const BetHandler &handler)
+{
+	const std::string_view prediction_id = json_string(event, "id");
+	if (prediction_id.empty()) {
+		return Result::Invalid;
+	}
+
+	// A missed `begin` (e.g. connecting mid-prediction) is recovered from the first event seen
+	if (Phase == PredictionPhase::Begin or !m_prediction_pool.is_current(prediction_id)) {
+		m_prediction_pool.begin(prediction_id);
+	}
+
+	if (event.HasMember("outcomes") and event["outcomes"].IsArray()) {
+		const std::string_view title = json_string(event, "title");
+		for (const auto &outcome : event["outcomes"].GetArray()) {
+			const std::string_view outcome_id = outcome.IsObject() ? json_string(outcome, "id") : "";
+			if (outcome_id.empty()) {
+				continue;
+			}
+
+			// Unchanged totals mean unchanged top predictors, so the array is skipped entirely
+			if (!m_prediction_pool.update_outcome(outcome_id, json_uint(outcome, "users"),
+							      json_uint(outcome, "channel_points")) or
+			    !outcome.HasMember("top_predictors") or !outcome["top_predictors"].IsArray()) {
+				continue;
+			}
+
+			for (const auto &predictor : outcome["top_predictors"].GetArray()) {
+				const std::string_view user_id =
+					predictor.IsObject() ? json_string(predictor, "user_id") : "";
+				if (user_id.empty()) {
+					continue;
+				}
+
+				const size_t points_used = json_uint(predictor, "channel_points_used");
+				const size_t previous =
+					m_prediction_pool.update_predictor(user_id, outcome_id, points_used);
+				if (points_used != previous) {
+					handler(Bet{Source::Prediction, points_used, previous, user_id,
+						    json_string(predictor, "user_name"), title});
+				}
+			}
+		}
+	}
+
+	if constexpr (Phase == PredictionPhase::Lock) {
+		m_prediction_pool.lock();
+		log_message(LogLevel::Info, "Prediction locked: %zu users, %zu channel points",
+			    m_prediction_pool.total_users(), m_prediction_pool.total_channel_points());
+	} else if constexpr (Phase == PredictionPhase::End) {
+		m_prediction_pool.end();
+		log_message(LogLevel::Info, "Prediction ended: %zu users, %zu channel points",
+			    m_prediction_pool.total_users(), m_prediction_pool.total_channel_points());
+	}
+	return Result::Decoded;
+}
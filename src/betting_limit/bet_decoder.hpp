@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <rapidjson/document.h>
+
+#include "prediction_pool.hpp"
+
+// Turns `notification` events into the bets the limit rule is applied to. A redemption is
+// one bet at its reward cost; a prediction event yields one bet per top predictor whose
+// spend changed, paired with the spend the pool knew before. EventSub and the offline
+// backtest both decode through this class, so a replay sees exactly what the live handler
+// saw. Not thread-safe.
+class BetDecoder {
+public:
+	enum class Source : uint8_t { Redemption, Prediction };
+	enum class Result : uint8_t { Decoded, Ignored, Invalid }; // Ignored: a subscription without bets
+
+	struct Bet {
+		Source source;
+		size_t amount;
+		size_t previous_amount;
+		std::string_view user_id; // stable Twitch id; `user` is the display name, which can change
+		std::string_view user;
+		std::string_view reward; // reward title, or the prediction title
+	};
+
+	using BetHandler = std::function<void(const Bet &)>;
+
+	BetDecoder(void);
+
+	// `handler` runs once per bet, in event order; the views are only valid during the call
+	Result decode(std::string_view subscription_type, const rapidjson::Value &event, const BetHandler &handler);
+
+	// Prediction bets depend on every earlier prediction event, so a replay must feed those in time order
+	static bool order_dependent(std::string_view subscription_type);
+
+	const PredictionPool &prediction_pool(void) const;
+
+private:
+	enum class PredictionPhase : uint8_t { Begin, Progress, Lock, End };
+	using Decoder = Result (BetDecoder::*)(const rapidjson::Value &, const BetHandler &);
+
+	static const Decoder *route(std::string_view subscription_type);
+
+	Result decode_redemption(const rapidjson::Value &event, const BetHandler &handler);
+	template<PredictionPhase Phase>
+	Result decode_prediction(const rapidjson::Value &event, const BetHandler &handler);
+
+	PredictionPool m_prediction_pool;
+};
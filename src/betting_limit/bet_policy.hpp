@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+// The limit rule shared by the live EventSub handler and the offline backtest.
+// `previous_amount` makes cumulative spends (prediction predictors) breach only once,
+// when they first cross the limit; plain redemptions pass 0.
+constexpr bool exceeds_limit(size_t amount, size_t previous_amount, size_t limit) noexcept
+{
+	return amount > limit and previous_amount <= limit;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// Receiver for every bet decision EventSub makes, registered with `EventSub::add_bet_sink`.
+// `publish` runs on the EventSub io thread right after the limit check and the views are
+// only valid during the call, so implementations copy what they keep and hand slow work
+// to their own thread (see WebhookSink).
+class BetSink {
+public:
+	enum class EventKind : uint8_t { Redemption, Breach };
+
+	struct Event {
+		EventKind kind;
+		std::string_view user, reward;
+		uint64_t amount, previous_amount, limit;
+		bool suppressed; // breach during a cooldown (EventSub::set_breach_cooldowns), no overlay shown
+	};
+
+	virtual ~BetSink(void) = default;
+	virtual void publish(const Event &event) = 0;
+};
@@ -0,0 +1,269 @@
+#include "event_ring.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+#include <boost/interprocess/exceptions.hpp>
+#include "logger.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr std::string_view RING_SEGMENT_PREFIX = "obs-twitch-limiter-";
+constexpr uint32_t RING_MAGIC = 0x54574C52U; // "TWLR"
+constexpr uint32_t RING_VERSION = 2U; // 2: events carry the user id
+constexpr uint64_t RING_CAPACITY = 4096UL;
+constexpr int64_t PUBLISHER_TIMEOUT_NS = 3'000'000'000LL; // publisher heartbeats every second
+//--------------------------------------------------------------
+struct EventRing::Header {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t capacity;
+	alignas(64) std::atomic<uint64_t> head;
+	alignas(64) std::atomic<int64_t> heartbeat;
+};
+
+struct EventRing::Slot {
+	std::atomic<uint64_t> sequence; // index + 1 once published, 0 while being written
+	Event event;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory ring requires lock-free 64-bit atomics");
+static_assert(std::is_trivially_copyable_v<EventRing::Event>, "ring events are copied with memcpy");
+
+static int64_t steady_nanoseconds(void)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+template<size_t N> static void copy_field(char (&destination)[N], std::string_view source)
+{
+	const size_t length = std::min(source.size(), N - 1UL);
+	std::memcpy(destination, source.data(), length);
+	destination[length] = '\0';
+}
+//--------------------------------------------------------------
+// **🔹 Constructor & Destructor**
+EventRing::EventRing(void)
+	: m_role(Role::None),
+	  m_segment_name(),
+	  m_segment(),
+	  m_region(),
+	  m_header(nullptr),
+	  m_slots(nullptr),
+	  m_cursor(0UL),
+	  m_dropped(0UL)
+{
+}
+
+EventRing::~EventRing(void)
+{
+	detach();
+}
+
+// **🔹 Publisher Side**
+bool EventRing::create(std::string_view name)
+{
+	const std::string segment = segment_name(name);
+
+	// Replacing a segment whose publisher is still heartbeating would orphan it: its consumers keep
+	// the old mapping and, with it, a live heartbeat from a session that no longer gets our events
+	if (attach(name)) {
+		if (publisher_alive()) {
+			log_message(LogLevel::Warning, "Shared EventSub ring '%s' already has a live publisher",
+				    segment.c_str());
+			return false;
+		}
+		detach();
+	}
+
+	try {
+		// Otherwise start from a fresh segment; consumers of a previous publisher notice the
+		// stale heartbeat on their old mapping and re-attach to this one
+		boost::interprocess::shared_memory_object::remove(segment.c_str());
+		m_segment = boost::interprocess::shared_memory_object(boost::interprocess::create_only, segment.c_str(),
+								      boost::interprocess::read_write);
+		m_segment.truncate(static_cast<boost::interprocess::offset_t>(sizeof(Header) +
+									      RING_CAPACITY * sizeof(Slot)));
+		m_region = boost::interprocess::mapped_region(m_segment, boost::interprocess::read_write);
+	} catch (const boost::interprocess::interprocess_exception &e) {
+		log_message(LogLevel::Error, "Failed to create shared EventSub ring '%s': %s", segment.c_str(),
+			    e.what());
+		detach();
+		return false;
+	}
+
+	m_header = new (m_region.get_address()) Header{RING_MAGIC, RING_VERSION, RING_CAPACITY, {0UL}, {0LL}};
+	m_slots = reinterpret_cast<Slot *>(static_cast<char *>(m_region.get_address()) + sizeof(Header));
+	for (uint64_t i = 0UL; i < RING_CAPACITY; ++i) {
+		new (&m_slots[i]) Slot{{0UL}, {}};
+	}
+
+	m_segment_name = segment;
+	m_role = Role::Publisher;
+	heartbeat();
+	log_message(LogLevel::Info, "Publishing EventSub events to shared ring '%s'", segment.c_str());
+	return true;
+}
+
+void EventRing::publish(const Event &event)
+{
+	if (m_role != Role::Publisher) {
+		return;
+	}
+
+	const uint64_t index = m_header->head.load(std::memory_order_relaxed);
+	Slot &slot = m_slots[index % m_header->capacity];
+
+	slot.sequence.store(0UL, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(&slot.event, &event, sizeof(Event));
+	slot.sequence.store(index + 1UL, std::memory_order_release);
+	m_header->head.store(index + 1UL, std::memory_order_release);
+}
+
+void EventRing::heartbeat(void)
+{
+	if (m_role == Role::Publisher) {
+		m_header->heartbeat.store(steady_nanoseconds(), std::memory_order_relaxed);
+	}
+}
+
+// **🔹 Consumer Side**
+bool EventRing::attach(std::string_view name)
+{
+	detach();
+	const std::string segment = segment_name(name);
+
+	try {
+		m_segment = boost::interprocess::shared_memory_object(boost::interprocess::open_only, segment.c_str(),
+								      boost::interprocess::read_write);
+		m_region = boost::interprocess::mapped_region(m_segment, boost::interprocess::read_write);
+	} catch (const boost::interprocess::interprocess_exception &) {
+		// No publisher yet; the caller retries
+		detach();
+		return false;
+	}
+
+	m_header = static_cast<Header *>(m_region.get_address());
+	if (m_region.get_size() < sizeof(Header) or m_header->magic != RING_MAGIC or
+	    m_header->version != RING_VERSION or
+	    m_region.get_size() < sizeof(Header) + m_header->capacity * sizeof(Slot)) {
+		log_message(LogLevel::Error, "Shared EventSub ring '%s' has an incompatible layout", segment.c_str());
+		detach();
+		return false;
+	}
+
+	m_slots = reinterpret_cast<Slot *>(static_cast<char *>(m_region.get_address()) + sizeof(Header));
+	m_cursor.store(m_header->head.load(std::memory_order_acquire)); // start at "now", no replay
+	m_segment_name = segment;
+	m_role = Role::Consumer;
+	return true;
+}
+
+size_t EventRing::consume(const std::function<void(const Event &)> &handler)
+{
+	if (m_role != Role::Consumer) {
+		return 0UL;
+	}
+
+	const uint64_t capacity = m_header->capacity;
+	uint64_t cursor = m_cursor.load(std::memory_order_relaxed);
+	size_t consumed = 0UL;
+
+	for (uint64_t head = m_header->head.load(std::memory_order_acquire); cursor < head;) {
+		// Lapped: the slots between cursor and head - capacity are already overwritten
+		if (head - cursor > capacity) {
+			m_dropped.fetch_add(head - capacity - cursor, std::memory_order_relaxed);
+			cursor = head - capacity;
+		}
+
+		const Slot &slot = m_slots[cursor % capacity];
+		const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+		Event event;
+		std::memcpy(&event, &slot.event, sizeof(Event));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+
+		if (before != cursor + 1UL or after != before) {
+			// Overwritten while reading; resume at the oldest slot that cannot be mid-write
+			head = m_header->head.load(std::memory_order_acquire);
+			const uint64_t oldest = head > capacity ? head - capacity + 1UL : 0UL;
+			const uint64_t resume = std::max(cursor + 1UL, oldest);
+			m_dropped.fetch_add(resume - cursor, std::memory_order_relaxed);
+			cursor = resume;
+			continue;
+		}
+
+		handler(event);
+		++cursor;
+		++consumed;
+	}
+
+	m_cursor.store(cursor, std::memory_order_relaxed);
+	return consumed;
+}
+
+bool EventRing::publisher_alive(void) const
+{
+	if (m_role == Role::None) {
+		return false;
+	}
+	return steady_nanoseconds() - m_header->heartbeat.load(std::memory_order_relaxed) < PUBLISHER_TIMEOUT_NS;
+}
+
+// **🔹 Shared Helpers**
+void EventRing::detach(void)
+{
+	if (m_role == Role::Publisher) {
+		boost::interprocess::shared_memory_object::remove(m_segment_name.c_str());
+	}
+
+	m_region = boost::interprocess::mapped_region();
+	m_segment = boost::interprocess::shared_memory_object();
+	m_header = nullptr;
+	m_slots = nullptr;
+	m_role = Role::None;
+	m_segment_name.clear();
+}
+
+EventRing::Role EventRing::role(void) const
+{
+	return m_role;
+}
+
+size_t EventRing::pending(void) const
+{
+	if (m_role != Role::Consumer) {
+		return 0UL;
+	}
+	return static_cast<size_t>(m_header->head.load(std::memory_order_relaxed) -
+				   m_cursor.load(std::memory_order_relaxed));
+}
+
+uint64_t EventRing::dropped(void) const
+{
+	return m_dropped.load(std::memory_order_relaxed);
+}
+
+EventRing::Event EventRing::make_event(EventKind kind, uint64_t amount, uint64_t previous_amount,
+				       std::string_view user_id, std::string_view user, std::string_view title)
+{
+	Event event{kind, 0U, amount, previous_amount, {}, {}, {}};
+	copy_field(event.user_id, user_id);
+	copy_field(event.user, user);
+	copy_field(event.title, title);
+	return event;
+}
+
+std::string EventRing::segment_name(std::string_view name)
+{
+	std::string segment(RING_SEGMENT_PREFIX);
+	for (const char c : name) {
+		const bool valid = (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or (c >= '0' and c <= '9') or
+				   c == '-' or c == '_';
+		segment.push_back(valid ? c : '_');
+	}
+	return segment;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+// Broadcast ring in shared memory: one OBS instance (the publisher) owns the EventSub
+// session and writes decoded events; any number of consumer instances on the same host
+// read them with private cursors. Slots are guarded by a per-slot sequence (seqlock), so
+// neither side ever blocks; a consumer that falls more than a ring behind skips ahead.
+class EventRing {
+public:
+	enum class Role : uint8_t { None, Publisher, Consumer };
+	enum class EventKind : uint32_t { Redemption = 1U, Prediction = 2U };
+
+	struct Event {
+		EventKind kind;
+		uint32_t reserved;
+		uint64_t amount;
+		uint64_t previous_amount;
+		char user_id[24];
+		char user[48];
+		char title[64];
+	};
+
+	EventRing(void);
+	~EventRing(void);
+	EventRing(const EventRing &) = delete;
+	EventRing(EventRing &&) = delete;
+	EventRing &operator=(const EventRing &) = delete;
+	EventRing &operator=(EventRing &&) = delete;
+
+	// Refuses (returns false) while another live publisher owns `name`; the ring is then left attached
+	// to it as a consumer. A segment with a stale heartbeat is replaced.
+	bool create(std::string_view name);
+	bool attach(std::string_view name);
+	void detach(void);
+
+	Role role(void) const;
+	bool publisher_alive(void) const;
+	void heartbeat(void);
+
+	void publish(const Event &event);
+	size_t consume(const std::function<void(const Event &)> &handler);
+
+	size_t pending(void) const;
+	uint64_t dropped(void) const;
+
+	static Event make_event(EventKind kind, uint64_t amount, uint64_t previous_amount, std::string_view user_id,
+				std::string_view user, std::string_view title);
+
+private:
+	struct Header;
+	struct Slot;
+
+	static std::string segment_name(std::string_view name);
+
+	Role m_role;
+	std::string m_segment_name;
+	boost::interprocess::shared_memory_object m_segment;
+	boost::interprocess::mapped_region m_region;
+	Header *m_header;
+	Slot *m_slots;
+	std::atomic<uint64_t> m_cursor, m_dropped;
+};
@@ -4,20 +4,39 @@
 #include <limits>
 #include <regex>
 #include <algorithm>
+#include <filesystem>
+#include "bet_policy.hpp"
+#include "metrics.hpp"
+#include "perfect_hash.hpp"
+#include "eventsub_json.hpp"
 #include <rapidjson/document.h>
-#include <obs-module.h>
-#include <obs.h>
+#include "logger.hpp"
 //--------------------------------------------------------------
 // Definition
 //--------------------------------------------------------------
 constexpr std::string_view EVENTSUB_WEBSOCKET_URL = "wss://eventsub.wss.twitch.tv/ws";
 constexpr std::string_view EVENTSUB_PORT = "443";
-constexpr std::string_view BET_LIMIT_WARNING = "Bet exceeds limit! Max: ";
+constexpr std::string_view DEFAULT_OVERLAY_TEMPLATE = "Bet exceeds limit! Max: {limit}";
 constexpr std::string_view EVENTSUB_TYPE_NOTIFICATION = "notification";
-constexpr std::string_view EVENTSUB_BET_EVENT = "channel.channel_points_custom_reward_redemption.add";
+constexpr std::string_view EVENTSUB_TYPE_WELCOME = "session_welcome";
+constexpr std::string_view EVENTSUB_TYPE_KEEPALIVE = "session_keepalive";
+constexpr std::string_view EVENTSUB_TYPE_RECONNECT = "session_reconnect";
+constexpr std::string_view EVENTSUB_TYPE_REVOCATION = "revocation";
 constexpr size_t MAX_RECONNECT_DELAY = 24UL * 60UL * 60UL; // 24 hours in seconds
 constexpr size_t DEFAULT_MAX_BET_LIMIT = 5000UL;
 constexpr size_t DEFAULT_BET_TIMEOUT = 30UL;
+constexpr size_t DEFAULT_KEEPALIVE_TIMEOUT = 10UL; // Twitch default until `session_welcome` says otherwise
+constexpr std::string_view WEBHOOK_SPILL_DIRECTORY = "twitch-limiter";
+constexpr auto FANOUT_POLL_INTERVAL = std::chrono::milliseconds(20);
+constexpr auto FANOUT_IDLE_INTERVAL = std::chrono::seconds(1); // publisher heartbeat / consumer re-attach
+//--------------------------------------------------------------
+// Dispatch targets for the compile-time message_type table; subscription types are routed by BetDecoder
+using EventSubHandler = void (EventSub::*)(const rapidjson::Value &);
+
+struct MessageRoute {
+	EventSubHandler handler; // receives the payload; nullptr when counting is all that is needed
+	Metrics::MessageType metric;
+};
 //--------------------------------------------------------------
 // **🔹 Singleton Instance**
 EventSub &EventSub::instance(void)
@@ -29,17 +48,43 @@ EventSub &EventSub::instance(void)
 // **🔹 Constructor & Destructor**
 EventSub::EventSub(void)
 	: m_connected(false),
+	  m_running(false),
+	  m_breach_cooldowns(false),
 	  m_max_bet_limit(DEFAULT_MAX_BET_LIMIT),
 	  m_bet_timeout_duration(DEFAULT_BET_TIMEOUT),
 	  m_reconnect_attempts(0UL),
+	  m_keepalive_timeout(DEFAULT_KEEPALIVE_TIMEOUT),
+	  m_ping_sent(false),
+	  m_closing(false),
+	  m_connect_started(false),
+	  m_fanout_attached(false),
+	  m_fanout_standby(false),
+	  m_fanout_mode(FanoutMode::Standalone),
 	  m_websocket_url(std::string(EVENTSUB_WEBSOCKET_URL)),
+	  m_websocket_url_mutex(),
+	  m_session_url(),
 	  m_io_context(),
 	  m_resolver(m_io_context),
-	  m_websocket(m_io_context),
+	  m_websocket(),
 	  m_reconnect_timer(m_io_context),
-	  m_buffer()
+	  m_keepalive_timer(m_io_context),
+	  m_last_frame(std::chrono::steady_clock::now()),
+	  m_buffer(),
+	  m_bet_decoder(),
+	  m_metrics_server(m_io_context),
+	  m_fanout_timer(m_io_context),
+	  m_event_ring(),
+	  m_timing_wheel(m_io_context),
+	  m_adaptive_limit(),
+	  m_adaptive_decay(),
+	  m_overlay_template(),
+	  m_breach_count(0UL),
+	  m_webhook_sink(),
+	  m_bet_sinks{&m_webhook_sink}
 {
+	m_overlay_template.compile(DEFAULT_OVERLAY_TEMPLATE);
 	m_work_guard.emplace(m_io_context.get_executor());
+	Metrics::instance().register_queue_depth("fanout_ring", [this]() { return m_event_ring.pending(); });
 }
 
 EventSub::~EventSub(void)
@@ -51,69 +96,92 @@ EventSub::~EventSub(void)
 // **🔹 Initialize WebSocket Connection**
 void EventSub::initialize(void)
 {
-	blog(LOG_INFO, "EventSub connection initializing...");
-	std::thread([this]() { this->m_io_context.run(); }).detach();
-
-	m_reconnect_timer.expires_after(std::chrono::seconds(10));
-	m_reconnect_timer.async_wait(
-		[this](const boost::system::error_code &ec) { this->check_connection_status(ec); });
+	log_message(LogLevel::Info, "EventSub connection initializing...");
+	// Handlers assume a single io thread; a manual reconnect must not start a second one
+	if (!m_running.exchange(true)) {
+		std::thread([this]() { this->m_io_context.run(); }).detach();
+	}
 
-	async_connect();
-	blog(LOG_INFO, "EventSub connection initialized.");
+	boost::asio::post(m_io_context, [this]() { async_connect(); });
+	log_message(LogLevel::Info, "EventSub connection initialized.");
 }
 
 // **🔹 Shutdown WebSocket Connection**
+// The stream, timers and resolver belong to the io thread, which may be replacing the stream right now
 void EventSub::shutdown(void)
 {
-	blog(LOG_INFO, "EventSub connection closed.");
-	if (m_connected.load()) {
-		m_websocket.close(boost::beast::websocket::close_code::normal);
-		notify_status(false);
+	log_message(LogLevel::Info, "EventSub connection closed.");
+	boost::asio::post(m_io_context, [this]() { close_session(); });
+}
+
+// Stops any pending attempt as well; the aborted read sees `m_closing` and does not reconnect
+void EventSub::close_session(void)
+{
+	m_reconnect_timer.cancel();
+	m_resolver.cancel();
+	m_keepalive_timer.cancel();
+	if (!m_connected.load() or !m_websocket) {
+		return;
 	}
+
+	m_closing = true;
+	notify_status(false);
+	m_websocket->async_close(boost::beast::websocket::close_code::normal, [](const boost::system::error_code &) {});
 }
 
 // **🔹 Set Max Bet Limit**
 void EventSub::set_max_bet_limit(const size_t &limit)
 {
 	m_max_bet_limit.store(limit);
-	blog(LOG_INFO, "New Bet Timeout Duration: %zu seconds", limit);
+	log_message(LogLevel::Info, "New Bet Timeout Duration: %zu seconds", limit);
 }
 
 void EventSub::set_max_bet_limit(bool enable, const size_t &limit)
 {
 	m_max_bet_limit.store(enable ? limit : std::numeric_limits<size_t>::max());
-	blog(LOG_INFO, "New Bet Timeout Duration: %zu seconds", limit);
+	log_message(LogLevel::Info, "New Bet Timeout Duration: %zu seconds", limit);
 }
 
 void EventSub::set_max_bet_limit(bool enable)
 {
 	m_max_bet_limit.store(enable ? m_max_bet_limit.load() : std::numeric_limits<size_t>::max());
-	blog(LOG_INFO, "New Bet Timeout Duration: %zu seconds", m_max_bet_limit.load());
+	log_message(LogLevel::Info, "New Bet Timeout Duration: %zu seconds", m_max_bet_limit.load());
 }
 
 // **🔹 Set Bet Timeout Duration**
 void EventSub::set_bet_timeout_duration(const size_t &duration)
 {
 	m_bet_timeout_duration.store(duration);
-	blog(LOG_INFO, "New Bet Timeout Duration: %zu seconds", duration);
+	log_message(LogLevel::Info, "New Bet Timeout Duration: %zu seconds", duration);
+}
+
+void EventSub::set_breach_cooldowns(bool enable)
+{
+	m_breach_cooldowns.store(enable);
+	log_message(LogLevel::Info, "Breach cooldowns %s", enable ? "enabled" : "disabled");
 }
 
 void EventSub::set_websocket_url(std::string_view url)
 {
-	if (url.empty() or !valid_websocket_url(url)) {
-		m_websocket_url = std::string(EVENTSUB_WEBSOCKET_URL);
-		blog(LOG_INFO, "WebSocket URL reset to default: %s", m_websocket_url.c_str());
-	} else {
-		m_websocket_url = std::string(url);
-		blog(LOG_INFO, "WebSocket URL updated: %s", m_websocket_url.c_str());
+	{
+		std::lock_guard<std::mutex> lock(m_websocket_url_mutex);
+		if (url.empty() or !valid_websocket_url(url)) {
+			m_websocket_url = std::string(EVENTSUB_WEBSOCKET_URL);
+			log_message(LogLevel::Info, "WebSocket URL reset to default: %s", m_websocket_url.c_str());
+		} else {
+			m_websocket_url = std::string(url);
+			log_message(LogLevel::Info, "WebSocket URL updated: %s", m_websocket_url.c_str());
+		}
 	}
 
 	// If already connected, reconnect with the new URL
-	if (m_connected.load()) {
-		blog(LOG_INFO, "Reconnecting with new WebSocket URL...");
-		shutdown();
-		async_connect();
-	}
+	boost::asio::post(m_io_context, [this]() {
+		if (m_connected.load()) {
+			log_message(LogLevel::Info, "Reconnecting with new WebSocket URL...");
+			close_session();
+			async_connect();
+		}
+	});
 }
 void EventSub::set_websocket_url(void)
 {
@@ -131,9 +199,240 @@ size_t EventSub::get_bet_timeout_duration(void) const
 
 std::string EventSub::get_websocket_url(void) const
 {
+	std::lock_guard<std::mutex> lock(m_websocket_url_mutex);
 	return m_websocket_url;
 }
 
+// **🔹 Metrics Endpoint**
+void EventSub::set_metrics_endpoint(bool enable, const size_t &port)
+{
+	const uint16_t listen_port =
+		static_cast<uint16_t>((port > 0UL and port <= 65535UL) ? port : MetricsServer::DEFAULT_PORT);
+
+	// The server lives on the EventSub io_context; hop onto it instead of touching it from the UI thread
+	boost::asio::post(m_io_context, [this, enable, listen_port]() {
+		if (enable) {
+			m_metrics_server.start(listen_port);
+		} else {
+			m_metrics_server.stop();
+		}
+	});
+}
+
+// **🔹 Adaptive Limit**
+void EventSub::set_adaptive_limit(bool enable, const size_t &tighten_percent)
+{
+	const size_t percent = tighten_percent > 0UL ? tighten_percent : AdaptiveLimit::DEFAULT_TIGHTEN_PERCENT;
+	boost::asio::post(m_io_context, [this, enable, percent]() { m_adaptive_limit.configure(enable, percent); });
+}
+
+AdaptiveLimit::Status EventSub::get_adaptive_limit_status(void) const
+{
+	return m_adaptive_limit.status();
+}
+
+// **🔹 Overlay Template**
+// Compiled on the caller's thread; only the finished segment list is handed to the io thread
+bool EventSub::set_overlay_template(std::string_view text)
+{
+	OverlayTemplate overlay_template;
+	const bool valid = overlay_template.compile(text.empty() ? DEFAULT_OVERLAY_TEMPLATE : text);
+	if (!valid) {
+		log_message(LogLevel::Warning, "Overlay template has unknown placeholders or unmatched braces: %s",
+			    overlay_template.source().c_str());
+	}
+
+	boost::asio::post(m_io_context, [this, overlay_template = std::move(overlay_template)]() mutable {
+		m_overlay_template = std::move(overlay_template);
+	});
+	return valid;
+}
+
+// **🔹 Webhook Sink**
+bool EventSub::set_webhook_endpoints(std::string_view urls, bool allow_remote)
+{
+	std::vector<std::string> endpoints;
+	size_t position = 0UL;
+	while ((position = urls.find_first_not_of(", \t\r\n", position)) != std::string_view::npos) {
+		const size_t end = std::min(urls.find_first_of(", \t\r\n", position), urls.size());
+		endpoints.emplace_back(urls.substr(position, end - position));
+		position = end;
+	}
+
+	std::error_code ec;
+	const std::filesystem::path temp_directory = std::filesystem::temp_directory_path(ec);
+	return m_webhook_sink.configure(
+		endpoints, (ec ? std::filesystem::path(".") : temp_directory) / WEBHOOK_SPILL_DIRECTORY, allow_remote);
+}
+
+// **🔹 Bet Sinks**
+void EventSub::add_bet_sink(BetSink *sink)
+{
+	boost::asio::post(m_io_context, [this, sink]() { m_bet_sinks.push_back(sink); });
+}
+
+// **🔹 Headless Driving**
+void EventSub::process_message(std::string_view message)
+{
+	Metrics::instance().observe(Metrics::Histogram::MessageBytes, message.size());
+	handle_message(message);
+}
+
+size_t EventSub::poll(void)
+{
+	return m_io_context.poll(); // the work guard keeps the io_context from stopping between polls
+}
+
+// **🔹 Shared-Session Fan-out**
+void EventSub::set_fanout_mode(FanoutMode mode, std::string_view session)
+{
+	boost::asio::post(m_io_context, [this, mode, session = std::string(session)]() {
+		this->apply_fanout_mode(mode, session);
+	});
+}
+
+EventSub::FanoutMode EventSub::get_fanout_mode(void) const
+{
+	return m_fanout_mode.load();
+}
+
+void EventSub::apply_fanout_mode(FanoutMode mode, const std::string &session)
+{
+	if (mode == m_fanout_mode.load() and session == m_fanout_session and !m_fanout_standby) {
+		return;
+	}
+
+	m_fanout_timer.cancel();
+	m_event_ring.detach();
+	notify_fanout_status(false);
+	m_fanout_session = session;
+	m_fanout_standby = false;
+
+	if (mode == FanoutMode::Publisher and !m_event_ring.create(session)) {
+		if (m_event_ring.role() == EventRing::Role::Consumer) {
+			// Another OBS instance already publishes this session; share it and take over when it stops
+			log_message(LogLevel::Warning, "Shared session '%s' is already published, consuming it.",
+				    session.c_str());
+			mode = FanoutMode::Consumer;
+			m_fanout_standby = true;
+		} else {
+			log_message(LogLevel::Error, "Shared session unavailable, running standalone.");
+			mode = FanoutMode::Standalone;
+		}
+	}
+	const FanoutMode previous = m_fanout_mode.exchange(mode);
+
+	if (mode == FanoutMode::Consumer) {
+		// The publisher owns the only connection; drop ours (handle_read sees the abort)
+		log_message(LogLevel::Info, "Using shared EventSub session '%s' instead of a direct connection.",
+			    session.c_str());
+		m_reconnect_timer.cancel();
+		m_resolver.cancel();
+		m_keepalive_timer.cancel();
+		if (m_websocket) {
+			boost::system::error_code ignored;
+			m_websocket->next_layer().close(ignored);
+		}
+	}
+
+	if (previous == FanoutMode::Consumer and mode != FanoutMode::Consumer) {
+		async_connect();
+	}
+
+	if (mode != FanoutMode::Standalone) {
+		fanout_tick(boost::system::error_code());
+	}
+}
+
+void EventSub::fanout_tick(const boost::system::error_code &ec)
+{
+	if (ec) {
+		return;
+	}
+
+	auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(FANOUT_IDLE_INTERVAL);
+	if (m_fanout_mode.load() == FanoutMode::Publisher) {
+		m_event_ring.heartbeat();
+	} else if (m_fanout_mode.load() == FanoutMode::Consumer) {
+		// Not attached yet, or the publisher restarted under a fresh segment
+		if (!m_event_ring.publisher_alive()) {
+			if (m_fanout_standby) {
+				const std::string session = m_fanout_session;
+				apply_fanout_mode(FanoutMode::Publisher, session); // the publisher we deferred to left
+				return;
+			}
+			m_event_ring.attach(m_fanout_session);
+		}
+
+		notify_fanout_status(m_event_ring.publisher_alive());
+		if (m_fanout_attached) {
+			m_event_ring.consume(
+				[this](const EventRing::Event &event) {
+					check_bet(event.amount, event.previous_amount, event.user_id, event.user,
+						  event.title);
+				});
+			interval = FANOUT_POLL_INTERVAL;
+		}
+	} else {
+		return;
+	}
+
+	m_fanout_timer.expires_after(interval);
+	m_fanout_timer.async_wait([this](const boost::system::error_code &ec) { this->fanout_tick(ec); });
+}
+
+void EventSub::notify_fanout_status(bool attached)
+{
+	if (attached == m_fanout_attached) {
+		return;
+	}
+
+	m_fanout_attached = attached;
+	log_message(LogLevel::Info, "Shared EventSub session '%s' %s", m_fanout_session.c_str(),
+		    attached ? "attached." : "lost, waiting for the publisher...");
+	Metrics::instance().set_connection_state(attached ? Metrics::ConnectionState::Connected
+							 : Metrics::ConnectionState::Disconnected);
+	if (m_status_callback) {
+		m_status_callback(attached);
+	}
+}
+
+void EventSub::publish_event(EventRing::EventKind kind, size_t amount, size_t previous_amount,
+			     std::string_view user_id, std::string_view user, std::string_view title)
+{
+	if (m_event_ring.role() == EventRing::Role::Publisher) {
+		m_event_ring.publish(EventRing::make_event(kind, amount, previous_amount, user_id, user, title));
+	}
+}
+
+// **🔹 Timeouts**
+TimingWheel::Handle EventSub::schedule_timeout(std::chrono::seconds delay, std::function<void(void)> callback)
+{
+	return m_timing_wheel.schedule(delay, std::move(callback));
+}
+
+void EventSub::cancel_timeout(TimingWheel::Handle handle)
+{
+	boost::asio::post(m_io_context, [this, handle]() mutable { m_timing_wheel.cancel(handle); });
+}
+
+bool EventSub::start_cooldown(std::unordered_map<std::string, TimingWheel::Handle> &cooldowns,
+			      std::string_view key)
+{
+	if (key.empty()) {
+		return false;
+	}
+
+	auto [it, inserted] = cooldowns.try_emplace(std::string(key));
+	if (!inserted) {
+		return true; // Already cooling down; the running cooldown is not extended
+	}
+
+	it->second = m_timing_wheel.schedule(std::chrono::seconds(m_bet_timeout_duration.load()),
+					     [&cooldowns, key = it->first]() { cooldowns.erase(key); });
+	return false;
+}
+
 // **🔹 Set OBS Callbacks**
 void EventSub::set_overlay_callback(std::function<void(std::string_view, size_t)> callback)
 {
@@ -149,6 +448,8 @@ void EventSub::set_status_callback(std::function<void(bool)> callback)
 void EventSub::notify_status(bool connected)
 {
 	m_connected.store(connected);
+	Metrics::instance().set_connection_state(connected ? Metrics::ConnectionState::Connected
+							  : Metrics::ConnectionState::Disconnected);
 	if (m_status_callback) {
 		m_status_callback(connected);
 	}
@@ -157,6 +458,7 @@ void EventSub::notify_status(bool connected)
 // **🔹 Notify OBS to Show Overlay**
 void EventSub::notify_overlay(std::string_view message, size_t duration) const
 {
+	Metrics::instance().increment(Metrics::Counter::OverlayUpdates);
 	if (m_overlay_callback) {
 		m_overlay_callback(message, duration);
 	}
@@ -165,55 +467,109 @@ void EventSub::notify_overlay(std::string_view message, size_t duration) const
 // **🔹 Async WebSocket Connection**
 void EventSub::async_connect(void)
 {
-	if (!valid_websocket_url(m_websocket_url)) {
-		blog(LOG_ERROR, "Invalid WebSocket URL: %s. Resetting to default.", m_websocket_url.c_str());
+	if (m_fanout_mode.load() == FanoutMode::Consumer) {
+		return; // Events arrive through the shared ring instead
+	}
+
+	if (const std::string url = get_websocket_url(); !valid_websocket_url(url)) {
+		log_message(LogLevel::Error, "Invalid WebSocket URL: %s. Resetting to default.", url.c_str());
 		set_websocket_url();
 	}
 
 	if (m_reconnect_attempts.load() >= MAX_RECONNECT_DELAY) {
-		blog(LOG_ERROR, "Max reconnect time (24 hours) reached. Manual reconnect required.");
+		log_message(LogLevel::Error, "Max reconnect time (24 hours) reached. Manual reconnect required.");
 		return;
 	}
 
 	const size_t delay = std::min<size_t>(5 * (1 << m_reconnect_attempts.load()),
 					      MAX_RECONNECT_DELAY); // Exponential backoff (5s * 2^n)
 
-	blog(LOG_INFO, "Attempting WebSocket reconnect (Attempt %zu), waiting %zu seconds",
-	     m_reconnect_attempts.load() + 1, delay);
+	log_message(LogLevel::Info, "Attempting WebSocket reconnect (Attempt %zu), waiting %zu seconds",
+		    m_reconnect_attempts.load() + 1, delay);
 
 	safe_increment();
+	Metrics::instance().set_connection_state(Metrics::ConnectionState::Connecting);
 
-	// Uses `m_reconnect_timer` to delay the connection attempt
-	m_reconnect_timer.expires_after(std::chrono::seconds(delay));
-	m_reconnect_timer.async_wait([this](const boost::system::error_code &) {
-		blog(LOG_INFO, "Resolving WebSocket URL: %s", m_websocket_url.c_str());
+	m_session_url.clear(); // a retry starts a new session on the configured URL
+	connect_after(std::chrono::seconds(delay));
+}
+
+// Uses `m_reconnect_timer` to delay the connection attempt
+void EventSub::connect_after(std::chrono::seconds delay)
+{
+	if (m_connect_started) {
+		Metrics::instance().increment(Metrics::Counter::Reconnects); // every attempt after the first
+	}
+	m_connect_started = true;
+
+	m_reconnect_timer.expires_after(delay);
+	m_reconnect_timer.async_wait([this](const boost::system::error_code &ec) {
+		if (connect_abandoned(ec)) {
+			return;
+		}
+
+		const auto parsed_url = parse_websocket_url(connection_url());
+		if (!parsed_url) {
+			log_message(LogLevel::Error, "WebSocket connection aborted due to invalid URL.");
+			return;
+		}
+
+		// Resolve the host part only; an explicit `:port` overrides the default
+		std::string host = parsed_url->first;
+		std::string port(EVENTSUB_PORT);
+		if (const size_t colon = host.find(':'); colon != std::string::npos) {
+			port = host.substr(colon + 1);
+			host.resize(colon);
+		}
+
+		reset_websocket();
+		log_message(LogLevel::Info, "Resolving WebSocket host: %s:%s", host.c_str(), port.c_str());
 		// Uses `m_resolver` to resolve Twitch's EventSub WebSocket server
-		m_resolver.async_resolve(m_websocket_url, EVENTSUB_PORT.data(),
+		m_resolver.async_resolve(host, port,
 					 [this](const boost::system::error_code &ec,
 						boost::asio::ip::tcp::resolver::results_type results) {
-						 if (!ec) {
-							 m_websocket.next_layer().async_connect(
-								 *results.begin(),
-								 [this](const boost::system::error_code &ec) {
-									 handle_connect(ec);
-								 });
-						 } else {
-							 blog(LOG_ERROR, "Failed to resolve Twitch EventSub host: %s",
-							      ec.message().c_str());
-							 async_connect(); // Retry on failure
-						 }
+						 handle_resolve(ec, std::move(results));
 					 });
 	});
 }
 
+// The `session_reconnect` URL while migrating a session, the configured one otherwise
+std::string EventSub::connection_url(void) const
+{
+	return m_session_url.empty() ? get_websocket_url() : m_session_url;
+}
+
+// A superseded timer, a cancelled resolve or a switch to Consumer mode ends the attempt silently
+bool EventSub::connect_abandoned(const boost::system::error_code &ec) const
+{
+	return ec == boost::asio::error::operation_aborted or m_fanout_mode.load() == FanoutMode::Consumer;
+}
+
+// **🔹 Fresh WebSocket Stream**
+// A stream that was closed, or failed mid-handshake, cannot be connected again; every attempt gets a new one
+void EventSub::reset_websocket(void)
+{
+	m_websocket.emplace(m_io_context);
+	m_buffer.clear();
+
+	// Pongs (and server pings) count as traffic for the keepalive watchdog
+	m_websocket->control_callback(
+		[this](boost::beast::websocket::frame_type, boost::beast::string_view) { this->record_frame(); });
+}
+
 // **🔹 Async Resolve Handler**
 void EventSub::handle_resolve(const boost::system::error_code &ec, boost::asio::ip::tcp::resolver::results_type results)
 {
+	if (connect_abandoned(ec)) {
+		return;
+	}
+
 	if (ec) {
-		blog(LOG_ERROR, "Failed to resolve Twitch EventSub host: %s", ec.message().c_str());
+		log_message(LogLevel::Error, "Failed to resolve Twitch EventSub host: %s", ec.message().c_str());
+		async_connect(); // Retry on failure
 		return;
 	}
-	m_websocket.next_layer().async_connect(*results.begin(), [this](const boost::system::error_code &ec) {
+	m_websocket->next_layer().async_connect(*results.begin(), [this](const boost::system::error_code &ec) {
 		this->handle_connect(ec);
 	});
 }
@@ -221,31 +577,42 @@ void EventSub::handle_resolve(const boost::system::error_code &ec, boost::asio::
 // **🔹 Async WebSocket Connection Handler**
 void EventSub::handle_connect(const boost::system::error_code &ec)
 {
+	if (connect_abandoned(ec)) {
+		return;
+	}
+
 	if (ec) {
-		blog(LOG_ERROR, "WebSocket Connection Failed: %s", ec.message().c_str());
-		std::this_thread::sleep_for(std::chrono::seconds(5));
-		async_connect();
+		log_message(LogLevel::Error, "WebSocket Connection Failed: %s", ec.message().c_str());
+		async_connect(); // The backoff timer waits; the io thread keeps serving everything else
 		return;
 	}
 
-	auto parsed_url = parse_websocket_url(m_websocket_url);
+	auto parsed_url = parse_websocket_url(connection_url());
 	if (!parsed_url) {
-		blog(LOG_ERROR, "WebSocket connection aborted due to invalid URL.");
+		log_message(LogLevel::Error, "WebSocket connection aborted due to invalid URL.");
 		return;
 	}
 
 	const auto [host, path] = parsed_url.value();
-	blog(LOG_INFO, "Connecting WebSocket: Host=%s, Path=%s", host.c_str(), path.c_str());
+	log_message(LogLevel::Info, "Connecting WebSocket: Host=%s, Path=%s", host.c_str(), path.c_str());
+
+	m_websocket->async_handshake(host, path, [this](const boost::system::error_code &ec) {
+		if (connect_abandoned(ec)) {
+			return;
+		}
 
-	m_websocket.async_handshake(host, path, [this](const boost::system::error_code &ec) {
 		if (ec) {
-			blog(LOG_ERROR, "WebSocket Handshake Failed: %s", ec.message().c_str());
+			log_message(LogLevel::Error, "WebSocket Handshake Failed: %s", ec.message().c_str());
+			notify_status(false);
+			async_connect(); // Same backoff as a dropped session
 			return;
 		}
 
-		blog(LOG_INFO, "Connected to Twitch EventSub!");
+		log_message(LogLevel::Info, "Connected to Twitch EventSub!");
 		m_reconnect_attempts.store(0UL); // Reset the counter
 		notify_status(true);
+		record_frame();
+		arm_keepalive_watchdog();
 		async_listenForBets();
 	});
 }
@@ -253,11 +620,11 @@ void EventSub::handle_connect(const boost::system::error_code &ec)
 // **🔹 Async WebSocket Listener**
 void EventSub::async_listenForBets(void)
 {
-	if (!m_websocket.is_open()) {
+	if (!m_websocket or !m_websocket->is_open()) {
 		return;
 	}
 
-	m_websocket.async_read(m_buffer, [this](const boost::system::error_code &ec, const size_t &bytes_transferred) {
+	m_websocket->async_read(m_buffer, [this](const boost::system::error_code &ec, const size_t &bytes_transferred) {
 		this->handle_read(ec, bytes_transferred, m_buffer);
 	});
 }
@@ -266,64 +633,234 @@ void EventSub::async_listenForBets(void)
 void EventSub::handle_read(const boost::system::error_code &ec, const size_t &bytes_transferred,
 			   boost::beast::flat_buffer &buffer)
 {
+	if (ec and m_fanout_mode.load() == FanoutMode::Consumer) {
+		m_connected.store(false); // Our socket was dropped on purpose; the ring reports the shared status
+		return;
+	}
+
+	if (ec and m_closing) {
+		m_closing = false; // Closed by shutdown, a URL change or a session migration, not lost
+		return;
+	}
+
 	if (ec) {
-		blog(LOG_ERROR, "WebSocket Read Error: %s", ec.message().c_str());
+		log_message(LogLevel::Error, "WebSocket Read Error: %s", ec.message().c_str());
 		notify_status(false);
 		async_connect(); // Attempt to reconnect on failure
 		return;
 	}
 
-	std::string response = boost::beast::buffers_to_string(buffer.data());
+	record_frame();
+	Metrics::instance().observe(Metrics::Histogram::MessageBytes, bytes_transferred);
 
+	// A flat_buffer is contiguous, so the frame is parsed in place before it is consumed
+	const auto frame = buffer.cdata();
+	handle_message(std::string_view(static_cast<const char *>(frame.data()), frame.size()));
 	buffer.consume(bytes_transferred);
+	async_listenForBets(); // Keep listening even if the message was invalid
+}
+
+// **🔹 Message Dispatch**
+void EventSub::handle_message(std::string_view message)
+{
+	const auto handle_start = std::chrono::steady_clock::now();
 
 	rapidjson::Document jsonResponse;
-	if (jsonResponse.Parse(response.data()).HasParseError()) {
-		blog(LOG_ERROR, "Failed to parse Twitch EventSub response");
-		async_listenForBets(); // Keep listening even if parsing fails
+	if (jsonResponse.Parse(message.data(), message.size()).HasParseError()) {
+		log_message(LogLevel::Error, "Failed to parse Twitch EventSub response");
+		Metrics::instance().increment(Metrics::Counter::ParseFailures);
 		return;
 	}
 
-	if (!jsonResponse.HasMember("type") or !jsonResponse["type"].IsString()) {
-		blog(LOG_ERROR, "Invalid response: Missing type field");
-		async_listenForBets(); // Continue listening
+	const std::string_view message_type = eventsub_message_type(jsonResponse);
+	if (message_type.empty()) {
+		log_message(LogLevel::Error, "Invalid response: Missing type field");
+		Metrics::instance().increment(Metrics::Counter::ParseFailures);
 		return;
 	}
 
-	if (jsonResponse["type"].GetString() == std::string(EVENTSUB_TYPE_NOTIFICATION) and
-	    jsonResponse["subscription"]["type"].GetString() == std::string(EVENTSUB_BET_EVENT)) {
+	// Adding a message type is a table entry; lookup cost does not grow with the table
+	static constexpr auto MESSAGE_ROUTES = make_perfect_hash_table<MessageRoute>({
+		{EVENTSUB_TYPE_NOTIFICATION, {&EventSub::handle_notification, Metrics::MessageType::Notification}},
+		{EVENTSUB_TYPE_KEEPALIVE, {nullptr, Metrics::MessageType::Keepalive}},
+		{EVENTSUB_TYPE_WELCOME, {&EventSub::handle_welcome, Metrics::MessageType::Welcome}},
+		{EVENTSUB_TYPE_RECONNECT, {&EventSub::handle_session_reconnect, Metrics::MessageType::Reconnect}},
+		{EVENTSUB_TYPE_REVOCATION, {nullptr, Metrics::MessageType::Revocation}},
+	});
 
-		if (jsonResponse.HasMember("event") and jsonResponse["event"].HasMember("reward") and
-		    jsonResponse["event"]["reward"].HasMember("cost") and
-		    jsonResponse["event"]["reward"]["cost"].IsUint()) {
+	const MessageRoute *route = MESSAGE_ROUTES.find(message_type);
+	Metrics::instance().count_message(route ? route->metric : Metrics::MessageType::Other);
+	if (route and route->handler) {
+		(this->*(route->handler))(eventsub_payload(jsonResponse));
+	}
 
-			const size_t bet_amount = jsonResponse["event"]["reward"]["cost"].GetUint();
-			if (bet_amount > m_max_bet_limit.load()) {
-				notify_overlay(BET_LIMIT_WARNING.data() + std::to_string(m_max_bet_limit.load()),
-					       m_bet_timeout_duration.load());
-			}
-		} else {
-			blog(LOG_ERROR, "Invalid bet event structure");
+	Metrics::instance().observe(Metrics::Histogram::HandleMicroseconds,
+				    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+								  std::chrono::steady_clock::now() - handle_start)
+								  .count()));
+}
+
+// **🔹 Limit Check**
+// Every bet feeds the adaptive controller, which may return a tightened limit during a burst.
+// With breach cooldowns enabled, a breach by a user (keyed by id, display names can change) or on a
+// reward that is still cooling down is counted but does not re-show the overlay.
+void EventSub::check_bet(size_t amount, size_t previous_amount, std::string_view user_id, std::string_view user,
+			 std::string_view reward)
+{
+	const size_t limit = m_adaptive_limit.observe(amount > previous_amount ? amount - previous_amount : 0UL,
+						      m_max_bet_limit.load(), std::chrono::steady_clock::now());
+	if (m_adaptive_limit.tightened() and !m_timing_wheel.pending(m_adaptive_decay)) {
+		schedule_adaptive_decay();
+	}
+	if (!exceeds_limit(amount, previous_amount, limit)) {
+		publish_bet({BetSink::EventKind::Redemption, user, reward, amount, previous_amount, limit, false});
+		return;
+	}
+
+	Metrics::instance().increment(Metrics::Counter::Breaches);
+	++m_breach_count;
+	bool cooling = false;
+	if (m_breach_cooldowns.load()) {
+		const bool user_cooling = start_cooldown(m_user_cooldowns, user_id);
+		const bool reward_cooling = start_cooldown(m_reward_cooldowns, reward);
+		cooling = user_cooling or reward_cooling;
+	}
+	publish_bet({BetSink::EventKind::Breach, user, reward, amount, previous_amount, limit, cooling});
+	if (cooling) {
+		return;
+	}
+
+	notify_overlay(m_overlay_template.render({user, amount, limit, reward, m_breach_count}),
+		       m_bet_timeout_duration.load());
+}
+
+// The controller only sees time pass when a bet arrives, so a burst followed by silence would
+// keep the limit tightened until the next bet; re-check on the wheel until it relaxes
+void EventSub::schedule_adaptive_decay(void)
+{
+	m_adaptive_decay = m_timing_wheel.schedule(AdaptiveLimit::DECAY_INTERVAL, [this]() {
+		if (m_adaptive_limit.decay(m_max_bet_limit.load(), std::chrono::steady_clock::now())) {
+			schedule_adaptive_decay();
 		}
+	});
+}
+
+void EventSub::publish_bet(const BetSink::Event &event)
+{
+	for (BetSink *sink : m_bet_sinks) {
+		sink->publish(event);
+	}
+}
+
+// **🔹 Session Welcome Handler**
+void EventSub::handle_welcome(const rapidjson::Value &payload)
+{
+	if (!payload.HasMember("session") or !payload["session"].IsObject()) {
+		log_message(LogLevel::Error, "Invalid session_welcome structure");
+		return;
 	}
 
-	async_listenForBets();
+	const size_t keepalive_timeout = json_uint(payload["session"], "keepalive_timeout_seconds");
+	if (keepalive_timeout > 0UL) {
+		m_keepalive_timeout.store(keepalive_timeout);
+		log_message(LogLevel::Info, "EventSub keepalive timeout: %zu seconds", keepalive_timeout);
+		arm_keepalive_watchdog();
+	}
 }
 
-void EventSub::check_connection_status(const boost::system::error_code &ec)
+// **🔹 Session Reconnect Handler**
+// Twitch is moving the session to another edge: connecting to `reconnect_url` right away keeps its
+// subscriptions, while a retry on the configured URL would start an empty session after the backoff.
+// The old connection is closed first (break before make), so events sent to it in between are lost.
+void EventSub::handle_session_reconnect(const rapidjson::Value &payload)
 {
-	if (ec) {
+	const rapidjson::Value *session = json_object(payload, "session");
+	const std::string_view reconnect_url = session ? json_string(*session, "reconnect_url") : std::string_view();
+	if (!valid_websocket_url(reconnect_url)) {
+		log_message(LogLevel::Error, "Invalid session_reconnect URL, keeping the current session");
+		return;
+	}
+
+	log_message(LogLevel::Info, "EventSub session moving to %.*s", static_cast<int>(reconnect_url.size()),
+		    reconnect_url.data());
+	std::string session_url(reconnect_url); // the payload is gone once the socket below is closed
+	close_session();
+	m_session_url = std::move(session_url);
+	connect_after(std::chrono::seconds(0));
+}
+
+// **🔹 Notification Handler**
+void EventSub::handle_notification(const rapidjson::Value &payload)
+{
+	const rapidjson::Value *event = json_object(payload, "event");
+	if (!event) {
+		log_message(LogLevel::Error, "Invalid notification: Missing event field");
+		return;
+	}
+
+	const rapidjson::Value *subscription = json_object(payload, "subscription");
+	const std::string_view subscription_type =
+		subscription ? json_string(*subscription, "type") : std::string_view();
+
+	const BetDecoder::Result result =
+		m_bet_decoder.decode(subscription_type, *event, [this](const BetDecoder::Bet &bet) {
+			publish_event(bet.source == BetDecoder::Source::Redemption ? EventRing::EventKind::Redemption
+										   : EventRing::EventKind::Prediction,
+				      bet.amount, bet.previous_amount, bet.user_id, bet.user, bet.reward);
+			check_bet(bet.amount, bet.previous_amount, bet.user_id, bet.user, bet.reward);
+		});
+	if (result == BetDecoder::Result::Invalid) {
+		log_message(LogLevel::Error, "Invalid %.*s event structure", static_cast<int>(subscription_type.size()),
+			    subscription_type.data());
+	}
+}
+
+// **🔹 Keepalive Watchdog**
+// Every inbound frame only stamps `m_last_frame`; the timer is never re-armed per frame.
+// When it fires it either sleeps until the (possibly moved) deadline, pings once at half
+// the timeout, or declares the session dead once the full timeout passed without traffic.
+void EventSub::record_frame(void)
+{
+	m_last_frame = std::chrono::steady_clock::now();
+	m_ping_sent = false;
+}
+
+void EventSub::arm_keepalive_watchdog(void)
+{
+	const auto timeout = std::chrono::seconds(m_keepalive_timeout.load());
+	m_keepalive_timer.expires_at(m_last_frame + (m_ping_sent ? timeout : timeout / 2));
+	m_keepalive_timer.async_wait([this](const boost::system::error_code &ec) { this->check_keepalive(ec); });
+}
+
+void EventSub::check_keepalive(const boost::system::error_code &ec)
+{
+	if (ec or !m_connected.load()) {
+		return;
+	}
+
+	const auto timeout = std::chrono::seconds(m_keepalive_timeout.load());
+	const auto idle = std::chrono::steady_clock::now() - m_last_frame;
+
+	if (idle >= timeout) {
+		const long long idle_ms = std::chrono::duration_cast<std::chrono::milliseconds>(idle).count();
+		log_message(LogLevel::Error,
+			    "No EventSub traffic for %lld ms, session considered dead. Reconnecting...", idle_ms);
+		// Aborts the pending read; `handle_read` reports the disconnect and reconnects
+		boost::system::error_code ignored;
+		m_websocket->next_layer().close(ignored);
 		return;
 	}
 
-	if (!m_connected.load()) {
-		blog(LOG_ERROR, "WebSocket Disconnected! Attempting reconnect...");
-		EventSub::async_connect();
+	if (!m_ping_sent and idle >= timeout / 2) {
+		m_ping_sent = true;
+		m_websocket->async_ping({}, [](const boost::system::error_code &ec) {
+			if (ec) {
+				log_message(LogLevel::Error, "WebSocket Ping Failed: %s", ec.message().c_str());
+			}
+		});
 	}
 
-	m_reconnect_timer.expires_after(std::chrono::seconds(10));
-	m_reconnect_timer.async_wait(
-		[this](const boost::system::error_code &ec) { this->check_connection_status(ec); });
+	arm_keepalive_watchdog();
 }
 
 void EventSub::safe_increment(void)
@@ -349,14 +886,14 @@ std::optional<std::pair<std::string, std::string>> EventSub::parse_websocket_url
 
 	const size_t scheme_end = url.find("://");
 	if (scheme_end == std::string_view::npos) {
-		blog(LOG_ERROR, "Invalid WebSocket URL (missing scheme): %s", url.data());
+		log_message(LogLevel::Error, "Invalid WebSocket URL (missing scheme): %s", url.data());
 		return std::nullopt;
 	}
 
 	std::string_view scheme = url.substr(0, scheme_end + 3);
 
 	if (scheme != WSS_SCHEME and scheme != HTTP_SCHEME and scheme != HTTPS_SCHEME and scheme != FTP_SCHEME) {
-		blog(LOG_ERROR, "Unsupported URL scheme: %s", scheme.data());
+		log_message(LogLevel::Error, "Unsupported URL scheme: %s", scheme.data());
 		return std::nullopt;
 	}
 
@@ -367,8 +904,8 @@ std::optional<std::pair<std::string, std::string>> EventSub::parse_websocket_url
 
 	std::string path = (path_start != url.end()) ? std::string(path_start, url.end()) : "/";
 
-	blog(LOG_INFO, "Parsed WebSocket URL -> Scheme: [%s], Host: [%s], Path: [%s]", scheme.data(), host.c_str(),
-	     path.c_str());
+	log_message(LogLevel::Info, "Parsed WebSocket URL -> Scheme: [%s], Host: [%s], Path: [%s]", scheme.data(),
+		    host.c_str(), path.c_str());
 
 	return std::make_pair(std::move(host), std::move(path));
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <cstdbool>
 #include <functional>
 #include <string>
@@ -8,6 +9,10 @@
 #include <atomic>
 #include <optional>
 #include <utility>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/steady_timer.hpp>
@@ -15,9 +20,23 @@
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/system/error_code.hpp>
+#include <rapidjson/document.h>
+
+#include "bet_decoder.hpp"
+#include "metrics_server.hpp"
+#include "event_ring.hpp"
+#include "timing_wheel.hpp"
+#include "adaptive_limit.hpp"
+#include "overlay_template.hpp"
+#include "webhook_sink.hpp"
+#include "bet_sink.hpp"
 
 class EventSub {
 public:
+	// Standalone: own connection. Publisher: own connection, shared with other OBS instances on this host.
+	// Consumer: no connection, events come from a publisher's shared-memory ring.
+	enum class FanoutMode : size_t { Standalone = 0UL, Publisher = 1UL, Consumer = 2UL };
+
 	static EventSub &instance(void); // Singleton instance
 
 	void initialize(void);
@@ -29,6 +48,10 @@ public:
 
 	void set_bet_timeout_duration(const size_t &duration);
 
+	// Off by default: a repeat breach by the same user, or on the same reward, within the bet timeout
+	// is still counted and published but does not show the overlay again
+	void set_breach_cooldowns(bool enable);
+
 	void set_websocket_url(std::string_view url);
 	void set_websocket_url(void);
 
@@ -37,6 +60,34 @@ public:
 
 	std::string get_websocket_url(void) const;
 
+	void set_metrics_endpoint(bool enable, const size_t &port);
+
+	void set_adaptive_limit(bool enable, const size_t &tighten_percent);
+	AdaptiveLimit::Status get_adaptive_limit_status(void) const;
+
+	// Returns false if the template has unknown placeholders or unmatched braces (they are shown verbatim)
+	bool set_overlay_template(std::string_view text);
+
+	// Comma or whitespace separated http:// URLs; empty stops the sink (undelivered events stay spilled).
+	// Only loopback hosts are accepted unless `allow_remote`.
+	bool set_webhook_endpoints(std::string_view urls, bool allow_remote = false);
+
+	// Takes effect on the io thread; the sink must outlive EventSub
+	void add_bet_sink(BetSink *sink);
+
+	// Headless drivers (tools, profiling) that never call initialize(): feed one EventSub message
+	// as if it had arrived on the WebSocket, and run the settings and timer handlers that are ready.
+	// Both must be called from the same thread.
+	void process_message(std::string_view message);
+	size_t poll(void);
+
+	void set_fanout_mode(FanoutMode mode, std::string_view session);
+	FanoutMode get_fanout_mode(void) const;
+
+	// Must be called from the EventSub io thread (e.g. from the overlay callback)
+	TimingWheel::Handle schedule_timeout(std::chrono::seconds delay, std::function<void(void)> callback);
+	void cancel_timeout(TimingWheel::Handle handle);
+
 	void set_overlay_callback(std::function<void(std::string_view, size_t)> callback);
 	void set_status_callback(std::function<void(bool)> callback);
 
@@ -49,6 +100,11 @@ protected:
 	EventSub &operator=(EventSub &&) = delete;
 
 	void async_connect(void);
+	void connect_after(std::chrono::seconds delay);
+	void close_session(void);
+	std::string connection_url(void) const;
+	void reset_websocket(void);
+	bool connect_abandoned(const boost::system::error_code &ec) const;
 	void async_listenForBets(void);
 
 	void notify_status(bool connected);
@@ -58,8 +114,25 @@ protected:
 	void handle_connect(const boost::system::error_code &ec);
 	void handle_read(const boost::system::error_code &ec, const size_t &bytes_transferred,
 			 boost::beast::flat_buffer &buffer);
-
-	void check_connection_status(const boost::system::error_code &ec);
+	void handle_message(std::string_view message);
+	void check_bet(size_t amount, size_t previous_amount, std::string_view user_id, std::string_view user,
+		       std::string_view reward);
+	void schedule_adaptive_decay(void);
+	void publish_bet(const BetSink::Event &event);
+	bool start_cooldown(std::unordered_map<std::string, TimingWheel::Handle> &cooldowns, std::string_view key);
+	void handle_welcome(const rapidjson::Value &payload);
+	void handle_session_reconnect(const rapidjson::Value &payload);
+	void handle_notification(const rapidjson::Value &payload);
+
+	void record_frame(void);
+	void arm_keepalive_watchdog(void);
+	void check_keepalive(const boost::system::error_code &ec);
+
+	void apply_fanout_mode(FanoutMode mode, const std::string &session);
+	void fanout_tick(const boost::system::error_code &ec);
+	void notify_fanout_status(bool attached);
+	void publish_event(EventRing::EventKind kind, size_t amount, size_t previous_amount, std::string_view user_id,
+			   std::string_view user, std::string_view title);
 
 	void safe_increment(void);
 
@@ -68,16 +141,37 @@ protected:
 	std::optional<std::pair<std::string, std::string>> parse_websocket_url(std::string_view url) const;
 
 private:
-	std::atomic<bool> m_connected;
-	std::atomic<size_t> m_max_bet_limit, m_bet_timeout_duration, m_reconnect_attempts;
-	std::string m_websocket_url;
+	std::atomic<bool> m_connected, m_running, m_breach_cooldowns;
+	std::atomic<size_t> m_max_bet_limit, m_bet_timeout_duration, m_reconnect_attempts, m_keepalive_timeout;
+	bool m_ping_sent, m_closing; // closing: the pending read was aborted on purpose, do not reconnect
+	bool m_connect_started;
+	bool m_fanout_attached, m_fanout_standby; // standby: asked to publish, another instance does
+	std::atomic<FanoutMode> m_fanout_mode;
+	std::string m_fanout_session;
+	std::string m_websocket_url; // set from the UI thread
+	mutable std::mutex m_websocket_url_mutex;
+	std::string m_session_url; // io thread: reconnect_url of a session being migrated
 
 	boost::asio::io_context m_io_context;
 	boost::asio::ip::tcp::resolver m_resolver;
-	boost::beast::websocket::stream<boost::asio::ip::tcp::socket> m_websocket;
+	std::optional<boost::beast::websocket::stream<boost::asio::ip::tcp::socket>> m_websocket; // one per attempt
 	boost::asio::steady_timer m_reconnect_timer;
+	boost::asio::steady_timer m_keepalive_timer;
+	std::chrono::steady_clock::time_point m_last_frame;
 	boost::beast::flat_buffer m_buffer;
 	std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> m_work_guard;
+	BetDecoder m_bet_decoder;
+	MetricsServer m_metrics_server;
+	boost::asio::steady_timer m_fanout_timer;
+	EventRing m_event_ring;
+	TimingWheel m_timing_wheel;
+	std::unordered_map<std::string, TimingWheel::Handle> m_user_cooldowns, m_reward_cooldowns; // by user id, title
+	AdaptiveLimit m_adaptive_limit;
+	TimingWheel::Handle m_adaptive_decay; // pending re-check while the limit is tightened
+	OverlayTemplate m_overlay_template;
+	uint64_t m_breach_count;
+	WebhookSink m_webhook_sink;
+	std::vector<BetSink *> m_bet_sinks;
 
 	std::function<void(std::string_view, size_t)> m_overlay_callback;
 	std::function<void(bool)> m_status_callback;
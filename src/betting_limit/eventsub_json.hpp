@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <rapidjson/document.h>
+
+// Accessors shared by everything that reads EventSub messages (the live handler, the bet
+// decoder and the offline tools). Twitch wraps messages as {metadata: {message_type},
+// payload: {subscription, event}}; the flat {type, subscription, event} layout is accepted
+// as well. A missing or mistyped member reads as empty, 0 or nullptr.
+inline std::string_view json_string(const rapidjson::Value &object, const char *key)
+{
+	auto it = object.FindMember(key);
+	if (it == object.MemberEnd() or !it->value.IsString()) {
+		return {};
+	}
+	return std::string_view(it->value.GetString(), it->value.GetStringLength());
+}
+
+inline size_t json_uint(const rapidjson::Value &object, const char *key)
+{
+	auto it = object.FindMember(key);
+	if (it == object.MemberEnd() or !it->value.IsUint64()) {
+		return 0UL;
+	}
+	return static_cast<size_t>(it->value.GetUint64());
+}
+
+inline const rapidjson::Value *json_object(const rapidjson::Value &object, const char *key)
+{
+	auto it = object.FindMember(key);
+	return (it != object.MemberEnd() and it->value.IsObject()) ? &it->value : nullptr;
+}
+
+inline std::string_view eventsub_message_type(const rapidjson::Value &message)
+{
+	if (!message.IsObject()) {
+		return {};
+	}
+	if (const rapidjson::Value *metadata = json_object(message, "metadata")) {
+		return json_string(*metadata, "message_type");
+	}
+	return json_string(message, "type");
+}
+
+inline const rapidjson::Value &eventsub_payload(const rapidjson::Value &message)
+{
+	const rapidjson::Value *payload = json_object(message, "payload");
+	return payload ? *payload : message;
+}
@@ -0,0 +1,57 @@
+#include "logger.hpp"
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr size_t INLINE_MESSAGE_SIZE = 512UL; // longer messages take one allocation
+//--------------------------------------------------------------
+static std::atomic<LogHandler> g_handler{nullptr};
+static std::atomic<LogLevel> g_level{LogLevel::Info};
+
+static void log_to_stderr(LogLevel level, const char *message)
+{
+	static constexpr const char *LEVEL_NAMES[] = {"error", "warning", "info", "debug"};
+	std::fprintf(stderr, "[%s] %s\n", LEVEL_NAMES[static_cast<int>(level)], message);
+}
+//--------------------------------------------------------------
+// **🔹 Configuration**
+void set_log_handler(LogHandler handler)
+{
+	g_handler.store(handler);
+}
+
+void set_log_level(LogLevel level)
+{
+	g_level.store(level);
+}
+
+// **🔹 Logging**
+void log_message(LogLevel level, const char *format, ...)
+{
+	if (level > g_level.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	char inline_message[INLINE_MESSAGE_SIZE];
+	std::string long_message;
+	const char *message = inline_message;
+
+	va_list args;
+	va_start(args, format);
+	va_list retry;
+	va_copy(retry, args);
+	const int length = std::vsnprintf(inline_message, sizeof(inline_message), format, args);
+	if (length >= static_cast<int>(sizeof(inline_message))) {
+		long_message.resize(static_cast<size_t>(length));
+		std::vsnprintf(long_message.data(), long_message.size() + 1UL, format, retry);
+		message = long_message.c_str();
+	}
+	va_end(retry);
+	va_end(args);
+
+	const LogHandler handler = g_handler.load(std::memory_order_acquire);
+	(handler ? handler : log_to_stderr)(level, length < 0 ? format : message);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// Logging for the limiter core, which must build without libobs. Messages at or below the
+// configured level are formatted and passed to the installed handler (the OBS plugin
+// forwards them to `blog`); with no handler they are written to stderr. Handler and
+// level are swapped atomically and messages may be logged from any thread.
+enum class LogLevel : int { Error, Warning, Info, Debug };
+
+using LogHandler = void (*)(LogLevel level, const char *message);
+
+void set_log_handler(LogHandler handler); // nullptr restores stderr
+void set_log_level(LogLevel level);       // more verbose messages are skipped before formatting
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 2, 3)))
+#endif
+void log_message(LogLevel level, const char *format, ...);
@@ -0,0 +1,222 @@
+#include "metrics.hpp"
+#include <chrono>
+#include <cstdio>
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr std::string_view METRICS_PREFIX = "twitch_limiter_";
+
+struct CounterInfo {
+	std::string_view name, help;
+};
+
+struct HistogramInfo {
+	std::string_view name, help;
+	std::array<uint64_t, 12> bounds;
+	size_t bucket_count;
+};
+
+constexpr std::array<CounterInfo, static_cast<size_t>(Metrics::Counter::Count)> COUNTERS = {{
+	{"parse_failures_total", "EventSub messages that failed to parse."},
+	{"breaches_total", "Bets that exceeded the configured limit."},
+	{"reconnects_total", "EventSub connection attempts after the first one."},
+	{"overlay_updates_total", "Overlay notifications shown."},
+	{"limit_tightenings_total", "Times the adaptive controller tightened the bet limit."},
+	{"webhook_batches_total", "Webhook batches acknowledged by an endpoint."},
+	{"webhook_dropped_total", "Webhook events dropped (rejected by the endpoint or spill file full)."},
+}};
+
+constexpr std::array<std::string_view, static_cast<size_t>(Metrics::MessageType::Count)> MESSAGE_TYPES = {
+	"session_welcome", "session_keepalive", "notification", "session_reconnect", "revocation", "other"};
+
+constexpr std::array<HistogramInfo, static_cast<size_t>(Metrics::Histogram::Count)> HISTOGRAMS = {{
+	{"message_handle_microseconds",
+	 "Time spent parsing and dispatching one EventSub message.",
+	 {5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000},
+	 11},
+	{"message_size_bytes",
+	 "Size of received EventSub messages.",
+	 {128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536},
+	 10},
+}};
+
+constexpr std::array<std::string_view, static_cast<size_t>(Metrics::ConnectionState::Count)> CONNECTION_STATES = {
+	"disconnected", "connecting", "connected"};
+//--------------------------------------------------------------
+static int64_t steady_nanoseconds(void)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+// Single-writer add: only the owning thread writes a shard, so no locked RMW is needed
+static void shard_add(std::atomic<uint64_t> &slot, uint64_t value)
+{
+	slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static void append_metric(std::string &out, std::string_view name, std::string_view help, std::string_view type)
+{
+	out.append("# HELP ").append(METRICS_PREFIX).append(name).append(" ").append(help).append("\n");
+	out.append("# TYPE ").append(METRICS_PREFIX).append(name).append(" ").append(type).append("\n");
+}
+//--------------------------------------------------------------
+// **🔹 Singleton Instance**
+Metrics &Metrics::instance(void)
+{
+	static Metrics instance;
+	return instance;
+}
+
+Metrics::Metrics(void)
+	: m_connection_state(static_cast<size_t>(ConnectionState::Disconnected)),
+	  m_state_since(steady_nanoseconds())
+{
+}
+
+// **🔹 Recording (hot path)**
+void Metrics::increment(Counter counter, uint64_t value)
+{
+	shard_add(local_shard().counters[static_cast<size_t>(counter)], value);
+}
+
+void Metrics::count_message(MessageType type)
+{
+	shard_add(local_shard().messages[static_cast<size_t>(type)], 1UL);
+}
+
+void Metrics::observe(Histogram histogram, uint64_t value)
+{
+	const HistogramInfo &info = HISTOGRAMS[static_cast<size_t>(histogram)];
+	HistogramShard &shard = local_shard().histograms[static_cast<size_t>(histogram)];
+
+	size_t bucket = 0UL;
+	while (bucket < info.bucket_count and value > info.bounds[bucket]) {
+		++bucket;
+	}
+
+	shard_add(shard.buckets[bucket], 1UL);
+	shard_add(shard.sum, value);
+	shard_add(shard.count, 1UL);
+}
+
+void Metrics::set_connection_state(ConnectionState state)
+{
+	const int64_t now = steady_nanoseconds();
+	const size_t previous = m_connection_state.exchange(static_cast<size_t>(state));
+	const int64_t since = m_state_since.exchange(now);
+	m_state_nanoseconds[previous].fetch_add(now - since, std::memory_order_relaxed);
+}
+
+void Metrics::register_queue_depth(std::string_view queue, std::function<size_t(void)> provider)
+{
+	std::lock_guard<std::mutex> lock(m_registry_mutex);
+	m_queue_depths.emplace_back(std::string(queue), std::move(provider));
+}
+
+Metrics::Shard &Metrics::local_shard(void)
+{
+	thread_local Shard *shard = nullptr;
+	if (!shard) {
+		std::lock_guard<std::mutex> lock(m_registry_mutex);
+		m_shards.push_back(std::make_unique<Shard>());
+		shard = m_shards.back().get();
+	}
+	return *shard;
+}
+
+// **🔹 Scrape (aggregates all shards)**
+std::string Metrics::scrape(void) const
+{
+	std::array<uint64_t, static_cast<size_t>(Counter::Count)> counters{};
+	std::array<uint64_t, static_cast<size_t>(MessageType::Count)> messages{};
+	std::array<std::array<uint64_t, MAX_BUCKETS + 3UL>, static_cast<size_t>(Histogram::Count)> histograms{};
+	std::vector<std::pair<std::string, size_t>> queue_depths;
+
+	{
+		std::lock_guard<std::mutex> lock(m_registry_mutex);
+		for (const auto &shard : m_shards) {
+			for (size_t i = 0UL; i < counters.size(); ++i) {
+				counters[i] += shard->counters[i].load(std::memory_order_relaxed);
+			}
+			for (size_t i = 0UL; i < messages.size(); ++i) {
+				messages[i] += shard->messages[i].load(std::memory_order_relaxed);
+			}
+			for (size_t h = 0UL; h < histograms.size(); ++h) {
+				const HistogramShard &source = shard->histograms[h];
+				for (size_t b = 0UL; b <= MAX_BUCKETS; ++b) {
+					histograms[h][b] += source.buckets[b].load(std::memory_order_relaxed);
+				}
+				histograms[h][MAX_BUCKETS + 1UL] += source.sum.load(std::memory_order_relaxed);
+				histograms[h][MAX_BUCKETS + 2UL] += source.count.load(std::memory_order_relaxed);
+			}
+		}
+		for (const auto &[queue, provider] : m_queue_depths) {
+			queue_depths.emplace_back(queue, provider());
+		}
+	}
+
+	std::string out;
+	out.reserve(4096UL);
+
+	append_metric(out, "messages_received_total", "EventSub messages received by message type.", "counter");
+	for (size_t i = 0UL; i < messages.size(); ++i) {
+		out.append(METRICS_PREFIX).append("messages_received_total{type=\"").append(MESSAGE_TYPES[i]);
+		out.append("\"} ").append(std::to_string(messages[i])).append("\n");
+	}
+
+	for (size_t i = 0UL; i < counters.size(); ++i) {
+		append_metric(out, COUNTERS[i].name, COUNTERS[i].help, "counter");
+		out.append(METRICS_PREFIX).append(COUNTERS[i].name).append(" ").append(std::to_string(counters[i]));
+		out.append("\n");
+	}
+
+	for (size_t h = 0UL; h < histograms.size(); ++h) {
+		const HistogramInfo &info = HISTOGRAMS[h];
+		append_metric(out, info.name, info.help, "histogram");
+
+		uint64_t cumulative = 0UL;
+		for (size_t b = 0UL; b <= info.bucket_count; ++b) {
+			cumulative += histograms[h][b];
+			const std::string bound = b < info.bucket_count ? std::to_string(info.bounds[b]) : "+Inf";
+			out.append(METRICS_PREFIX).append(info.name).append("_bucket{le=\"").append(bound).append("\"} ");
+			out.append(std::to_string(cumulative)).append("\n");
+		}
+		out.append(METRICS_PREFIX).append(info.name).append("_sum ");
+		out.append(std::to_string(histograms[h][MAX_BUCKETS + 1UL])).append("\n");
+		out.append(METRICS_PREFIX).append(info.name).append("_count ");
+		out.append(std::to_string(histograms[h][MAX_BUCKETS + 2UL])).append("\n");
+	}
+
+	const size_t current_state = m_connection_state.load();
+	const int64_t current_elapsed = steady_nanoseconds() - m_state_since.load();
+
+	append_metric(out, "connection_state", "Current EventSub connection state.", "gauge");
+	for (size_t i = 0UL; i < CONNECTION_STATES.size(); ++i) {
+		out.append(METRICS_PREFIX).append("connection_state{state=\"").append(CONNECTION_STATES[i]);
+		out.append("\"} ").append(i == current_state ? "1" : "0").append("\n");
+	}
+
+	append_metric(out, "connection_state_seconds_total", "Time spent in each EventSub connection state.",
+		      "counter");
+	for (size_t i = 0UL; i < CONNECTION_STATES.size(); ++i) {
+		int64_t nanoseconds = m_state_nanoseconds[i].load(std::memory_order_relaxed);
+		if (i == current_state) {
+			nanoseconds += current_elapsed;
+		}
+
+		char seconds[32];
+		std::snprintf(seconds, sizeof(seconds), "%.3f", static_cast<double>(nanoseconds) / 1e9);
+		out.append(METRICS_PREFIX).append("connection_state_seconds_total{state=\"").append(CONNECTION_STATES[i]);
+		out.append("\"} ").append(seconds).append("\n");
+	}
+
+	append_metric(out, "queue_depth", "Items waiting in internal plugin queues.", "gauge");
+	for (const auto &[queue, depth] : queue_depths) {
+		out.append(METRICS_PREFIX).append("queue_depth{queue=\"").append(queue).append("\"} ");
+		out.append(std::to_string(depth)).append("\n");
+	}
+
+	return out;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Process-wide plugin metrics in Prometheus text format. Each thread writes to its own
+// shard with relaxed loads/stores (no locks, no read-modify-write); shards are only
+// summed when `scrape()` is called, so recording never contends with anything.
+class Metrics {
+public:
+	enum class Counter : size_t { ParseFailures, Breaches, Reconnects, OverlayUpdates, LimitTightenings, WebhookBatches,
+				     WebhookDropped, Count };
+	enum class MessageType : size_t { Welcome, Keepalive, Notification, Reconnect, Revocation, Other, Count };
+	enum class Histogram : size_t { HandleMicroseconds, MessageBytes, Count };
+	enum class ConnectionState : size_t { Disconnected, Connecting, Connected, Count };
+
+	static Metrics &instance(void);
+
+	void increment(Counter counter, uint64_t value = 1UL);
+	void count_message(MessageType type);
+	void observe(Histogram histogram, uint64_t value);
+	void set_connection_state(ConnectionState state);
+
+	// Queue depths are sampled through the provider at scrape time only
+	void register_queue_depth(std::string_view queue, std::function<size_t(void)> provider);
+
+	std::string scrape(void) const;
+
+protected:
+	Metrics(void);
+	~Metrics(void) = default;
+	Metrics(const Metrics &) = delete;
+	Metrics(Metrics &&) = delete;
+	Metrics &operator=(const Metrics &) = delete;
+	Metrics &operator=(Metrics &&) = delete;
+
+private:
+	static constexpr size_t MAX_BUCKETS = 12UL;
+
+	struct HistogramShard {
+		std::array<std::atomic<uint64_t>, MAX_BUCKETS + 1UL> buckets{};
+		std::atomic<uint64_t> sum{0UL}, count{0UL};
+	};
+
+	struct Shard {
+		std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::Count)> counters{};
+		std::array<std::atomic<uint64_t>, static_cast<size_t>(MessageType::Count)> messages{};
+		std::array<HistogramShard, static_cast<size_t>(Histogram::Count)> histograms{};
+	};
+
+	Shard &local_shard(void);
+
+	mutable std::mutex m_registry_mutex;
+	std::vector<std::unique_ptr<Shard>> m_shards;
+	std::vector<std::pair<std::string, std::function<size_t(void)>>> m_queue_depths;
+
+	std::atomic<size_t> m_connection_state;
+	std::atomic<int64_t> m_state_since;
+	std::array<std::atomic<int64_t>, static_cast<size_t>(ConnectionState::Count)> m_state_nanoseconds{};
+};
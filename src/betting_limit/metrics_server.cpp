@@ -0,0 +1,146 @@
+#include "metrics_server.hpp"
+#include "metrics.hpp"
+#include <chrono>
+#include <memory>
+#include <string_view>
+#include <boost/asio/ip/address.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include "logger.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr std::string_view METRICS_LISTEN_ADDRESS = "127.0.0.1";
+constexpr std::string_view METRICS_PATH = "/metrics";
+constexpr std::string_view METRICS_CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8";
+constexpr auto METRICS_SESSION_TIMEOUT = std::chrono::seconds(5); // per read and per write
+//--------------------------------------------------------------
+// One request per connection; the session keeps itself alive through the handlers. A client that
+// stays silent or stops reading is cut off by the stream timeout, which ends the session.
+struct MetricsSession : std::enable_shared_from_this<MetricsSession> {
+	explicit MetricsSession(boost::asio::ip::tcp::socket socket) : stream(std::move(socket)) {}
+
+	void run(void)
+	{
+		stream.expires_after(METRICS_SESSION_TIMEOUT);
+		boost::beast::http::async_read(stream, buffer, request,
+					       [self = shared_from_this()](const boost::system::error_code &ec,
+									   size_t) { self->respond(ec); });
+	}
+
+	void respond(const boost::system::error_code &ec)
+	{
+		if (ec) {
+			return;
+		}
+
+		const auto target = request.target();
+		const bool found = request.method() == boost::beast::http::verb::get and
+				   std::string_view(target.data(), target.size()) == METRICS_PATH;
+
+		response.version(request.version());
+		response.keep_alive(false);
+		response.result(found ? boost::beast::http::status::ok : boost::beast::http::status::not_found);
+		response.set(boost::beast::http::field::content_type, METRICS_CONTENT_TYPE.data());
+		response.body() = found ? Metrics::instance().scrape() : std::string("Not Found\n");
+		response.prepare_payload();
+
+		stream.expires_after(METRICS_SESSION_TIMEOUT);
+		boost::beast::http::async_write(stream, response,
+						[self = shared_from_this()](const boost::system::error_code &, size_t) {
+							boost::system::error_code ignored;
+							self->stream.socket().shutdown(
+								boost::asio::ip::tcp::socket::shutdown_send, ignored);
+						});
+	}
+
+	boost::beast::tcp_stream stream;
+	boost::beast::flat_buffer buffer;
+	boost::beast::http::request<boost::beast::http::string_body> request;
+	boost::beast::http::response<boost::beast::http::string_body> response;
+};
+
+// **🔹 Constructor & Destructor**
+MetricsServer::MetricsServer(boost::asio::io_context &io_context) : m_io_context(io_context), m_acceptor(io_context) {}
+
+MetricsServer::~MetricsServer(void)
+{
+	stop();
+}
+
+// **🔹 Start / Stop**
+bool MetricsServer::start(uint16_t port)
+{
+	if (running() and this->port() == port) {
+		return true;
+	}
+	stop();
+
+	boost::system::error_code ec;
+	const boost::asio::ip::tcp::endpoint endpoint(
+		boost::asio::ip::make_address(std::string(METRICS_LISTEN_ADDRESS), ec), port);
+
+	m_acceptor.open(endpoint.protocol(), ec);
+	if (!ec) {
+		m_acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
+	}
+	if (!ec) {
+		m_acceptor.bind(endpoint, ec);
+	}
+	if (!ec) {
+		m_acceptor.listen(boost::asio::socket_base::max_listen_connections, ec);
+	}
+	if (ec) {
+		log_message(LogLevel::Error, "Failed to start metrics endpoint on port %u: %s",
+			    static_cast<unsigned>(port), ec.message().c_str());
+		stop();
+		return false;
+	}
+
+	log_message(LogLevel::Info, "Metrics endpoint listening on http://%s:%u%s", METRICS_LISTEN_ADDRESS.data(),
+		    static_cast<unsigned>(port), METRICS_PATH.data());
+	async_accept();
+	return true;
+}
+
+void MetricsServer::stop(void)
+{
+	if (m_acceptor.is_open()) {
+		boost::system::error_code ignored;
+		m_acceptor.close(ignored);
+		log_message(LogLevel::Info, "Metrics endpoint stopped.");
+	}
+}
+
+bool MetricsServer::running(void) const
+{
+	return m_acceptor.is_open();
+}
+
+uint16_t MetricsServer::port(void) const
+{
+	boost::system::error_code ec;
+	const auto endpoint = m_acceptor.local_endpoint(ec);
+	return ec ? 0U : endpoint.port();
+}
+
+// **🔹 Accept Loop**
+void MetricsServer::async_accept(void)
+{
+	m_acceptor.async_accept(m_io_context,
+				[this](const boost::system::error_code &ec, boost::asio::ip::tcp::socket socket) {
+					this->handle_accept(ec, std::move(socket));
+				});
+}
+
+void MetricsServer::handle_accept(const boost::system::error_code &ec, boost::asio::ip::tcp::socket socket)
+{
+	if (ec == boost::asio::error::operation_aborted or !m_acceptor.is_open()) {
+		return;
+	}
+
+	if (!ec) {
+		std::make_shared<MetricsSession>(std::move(socket))->run();
+	}
+	async_accept();
+}
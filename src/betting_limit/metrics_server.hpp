@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/system/error_code.hpp>
+
+// Minimal HTTP/1.1 endpoint serving `GET /metrics` on 127.0.0.1. Runs entirely on the
+// io_context it is given; all member functions must be called from that context.
+class MetricsServer {
+public:
+	static constexpr uint16_t DEFAULT_PORT = 9464U;
+
+	explicit MetricsServer(boost::asio::io_context &io_context);
+	~MetricsServer(void);
+	MetricsServer(const MetricsServer &) = delete;
+	MetricsServer(MetricsServer &&) = delete;
+	MetricsServer &operator=(const MetricsServer &) = delete;
+	MetricsServer &operator=(MetricsServer &&) = delete;
+
+	bool start(uint16_t port);
+	void stop(void);
+	bool running(void) const;
+	uint16_t port(void) const;
+
+protected:
+	void async_accept(void);
+	void handle_accept(const boost::system::error_code &ec, boost::asio::ip::tcp::socket socket);
+
+private:
+	boost::asio::io_context &m_io_context;
+	boost::asio::ip::tcp::acceptor m_acceptor;
+};
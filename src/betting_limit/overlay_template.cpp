@@ -0,0 +1,114 @@
+#include "overlay_template.hpp"
+#include "perfect_hash.hpp"
+#include <charconv>
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr size_t FIELD_RESERVE = 256UL; // user names and reward titles are short; longer ones grow the buffer once
+//--------------------------------------------------------------
+static void append_number(std::string &out, uint64_t value)
+{
+	char digits[20];
+	const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+	out.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+//--------------------------------------------------------------
+// **🔹 Constructor**
+OverlayTemplate::OverlayTemplate(void) : m_source(), m_literals(), m_segments(), m_buffer() {}
+
+// **🔹 Compile**
+bool OverlayTemplate::compile(std::string_view text)
+{
+	static constexpr auto PLACEHOLDERS = make_perfect_hash_table<Field>({
+		{"user", Field::User},
+		{"amount", Field::Amount},
+		{"limit", Field::Limit},
+		{"reward", Field::Reward},
+		{"count", Field::Count},
+	});
+
+	m_source = std::string(text);
+	m_literals.clear();
+	m_segments.clear();
+	bool valid = true;
+
+	for (size_t position = 0UL; position < text.size();) {
+		const size_t brace = text.find_first_of("{}", position);
+		if (brace == std::string_view::npos) {
+			add_literal(text.substr(position));
+			break;
+		}
+		add_literal(text.substr(position, brace - position));
+
+		// `{{` and `}}` are escaped braces
+		if (brace + 1UL < text.size() and text[brace + 1UL] == text[brace]) {
+			add_literal(text.substr(brace, 1UL));
+			position = brace + 2UL;
+			continue;
+		}
+
+		const size_t close = text[brace] == '{' ? text.find('}', brace + 1UL) : std::string_view::npos;
+		const Field *field =
+			close == std::string_view::npos ? nullptr : PLACEHOLDERS.find(text.substr(brace + 1UL, close - brace - 1UL));
+		if (!field) {
+			valid = false;
+			add_literal(text.substr(brace, 1UL));
+			position = brace + 1UL;
+			continue;
+		}
+
+		m_segments.push_back(Segment{*field, 0U, 0U});
+		position = close + 1UL;
+	}
+
+	m_buffer.reserve(m_literals.size() + FIELD_RESERVE);
+	return valid;
+}
+
+void OverlayTemplate::add_literal(std::string_view text)
+{
+	if (text.empty()) {
+		return;
+	}
+
+	// Merge with a directly preceding literal so render() appends it in one go
+	if (m_segments.empty() or m_segments.back().field != Field::Literal) {
+		m_segments.push_back(Segment{Field::Literal, static_cast<uint32_t>(m_literals.size()), 0U});
+	}
+	m_literals.append(text);
+	m_segments.back().length += static_cast<uint32_t>(text.size());
+}
+
+// **🔹 Render (hot path)**
+std::string_view OverlayTemplate::render(const Fields &fields)
+{
+	m_buffer.clear(); // keeps the capacity
+	for (const Segment &segment : m_segments) {
+		switch (segment.field) {
+		case Field::Literal:
+			m_buffer.append(m_literals.data() + segment.offset, segment.length);
+			break;
+		case Field::User:
+			m_buffer.append(fields.user);
+			break;
+		case Field::Amount:
+			append_number(m_buffer, fields.amount);
+			break;
+		case Field::Limit:
+			append_number(m_buffer, fields.limit);
+			break;
+		case Field::Reward:
+			m_buffer.append(fields.reward);
+			break;
+		case Field::Count:
+			append_number(m_buffer, fields.count);
+			break;
+		}
+	}
+	return m_buffer;
+}
+
+const std::string &OverlayTemplate::source(void) const
+{
+	return m_source;
+}
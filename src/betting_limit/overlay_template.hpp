@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// User-configurable overlay text with `{user}`, `{amount}`, `{limit}`, `{reward}` and
+// `{count}` placeholders (`{{` and `}}` for literal braces). `compile` splits the text
+// once into literal and field segments; `render` then only appends segments into a
+// buffer it keeps between calls, so after the first render nothing is allocated.
+// Compile anywhere, render from one thread at a time.
+class OverlayTemplate {
+public:
+	struct Fields {
+		std::string_view user;
+		uint64_t amount;
+		uint64_t limit;
+		std::string_view reward;
+		uint64_t count;
+	};
+
+	OverlayTemplate(void);
+
+	// Unknown placeholders and unmatched braces are kept as literal text; returns false if any were found
+	bool compile(std::string_view text);
+
+	// Valid until the next call to render() or compile()
+	std::string_view render(const Fields &fields);
+
+	const std::string &source(void) const;
+
+private:
+	enum class Field : uint8_t { Literal, User, Amount, Limit, Reward, Count };
+
+	struct Segment {
+		Field field;
+		uint32_t offset, length; // into m_literals, for Literal segments
+	};
+
+	void add_literal(std::string_view text);
+
+	std::string m_source;
+	std::string m_literals;
+	std::vector<Segment> m_segments;
+	std::string m_buffer;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <bit>
+#include <string_view>
+
+// Compile-time perfect hash from string keys to values (hash-and-displace). During
+// constant evaluation every bucket of keys is given a displacement that sends each of
+// its keys to a free slot; a lookup is then one FNV-1a pass, one displacement read, one
+// mix and one string compare, independent of how many keys are registered.
+template<typename Value> struct PerfectHashEntry {
+	std::string_view key;
+	Value value;
+};
+
+template<typename Value, size_t N> class PerfectHashTable {
+public:
+	static constexpr size_t CAPACITY = std::bit_ceil(N * 2UL);
+	static constexpr size_t BUCKETS = std::bit_ceil(N);
+
+	consteval explicit PerfectHashTable(const std::array<PerfectHashEntry<Value>, N> &entries)
+		: m_displacements{},
+		  m_slots{}
+	{
+		std::array<uint64_t, N> hashes{};
+		std::array<size_t, BUCKETS> bucket_sizes{};
+		for (size_t i = 0UL; i < N; ++i) {
+			hashes[i] = hash(entries[i].key);
+			++bucket_sizes[bucket(hashes[i])];
+		}
+
+		// Place the most crowded buckets first while the table is still empty
+		std::array<bool, BUCKETS> placed{};
+		for (size_t round = 0UL; round < BUCKETS; ++round) {
+			size_t current = 0UL;
+			for (size_t b = 0UL; b < BUCKETS; ++b) {
+				if (!placed[b] and (placed[current] or bucket_sizes[b] > bucket_sizes[current])) {
+					current = b;
+				}
+			}
+			placed[current] = true;
+			if (bucket_sizes[current] > 0UL) {
+				place_bucket(entries, hashes, current);
+			}
+		}
+	}
+
+	constexpr const Value *find(std::string_view key) const noexcept
+	{
+		const uint64_t key_hash = hash(key);
+		const Slot &candidate = m_slots[slot(key_hash, m_displacements[bucket(key_hash)])];
+		return (candidate.used and candidate.key == key) ? &candidate.value : nullptr;
+	}
+
+	constexpr size_t size(void) const noexcept { return N; }
+
+private:
+	struct Slot {
+		std::string_view key;
+		Value value;
+		bool used;
+	};
+
+	static constexpr uint64_t hash(std::string_view key) noexcept
+	{
+		uint64_t value = 14695981039346656037ULL;
+		for (const char c : key) {
+			value ^= static_cast<uint8_t>(c);
+			value *= 1099511628211ULL;
+		}
+		return value;
+	}
+
+	static constexpr size_t bucket(uint64_t key_hash) noexcept
+	{
+		return static_cast<size_t>((key_hash >> 32) & (BUCKETS - 1UL));
+	}
+
+	static constexpr size_t slot(uint64_t key_hash, uint32_t displacement) noexcept
+	{
+		// splitmix64 finaliser over the displaced hash
+		uint64_t value = key_hash ^ (static_cast<uint64_t>(displacement) * 0x9E3779B97F4A7C15ULL);
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+		value ^= value >> 31;
+		return static_cast<size_t>(value & (CAPACITY - 1UL));
+	}
+
+	consteval void place_bucket(const std::array<PerfectHashEntry<Value>, N> &entries,
+				    const std::array<uint64_t, N> &hashes, size_t target)
+	{
+		constexpr uint32_t MAX_DISPLACEMENT = 1U << 16;
+		for (uint32_t displacement = 0U; displacement < MAX_DISPLACEMENT; ++displacement) {
+			std::array<bool, CAPACITY> claimed{};
+			bool fits = true;
+			for (size_t i = 0UL; i < N and fits; ++i) {
+				if (bucket(hashes[i]) != target) {
+					continue;
+				}
+				const size_t index = slot(hashes[i], displacement);
+				fits = !m_slots[index].used and !claimed[index];
+				claimed[index] = true;
+			}
+			if (!fits) {
+				continue;
+			}
+
+			m_displacements[target] = displacement;
+			for (size_t i = 0UL; i < N; ++i) {
+				if (bucket(hashes[i]) == target) {
+					m_slots[slot(hashes[i], displacement)] = Slot{entries[i].key, entries[i].value, true};
+				}
+			}
+			return;
+		}
+		// Reached only with duplicate keys; fails constant evaluation
+		throw "PerfectHashTable: no displacement found (duplicate keys?)";
+	}
+
+	std::array<uint32_t, BUCKETS> m_displacements;
+	std::array<Slot, CAPACITY> m_slots;
+};
+
+template<typename Value, size_t N>
+consteval PerfectHashTable<Value, N> make_perfect_hash_table(const PerfectHashEntry<Value> (&entries)[N])
+{
+	std::array<PerfectHashEntry<Value>, N> table{};
+	for (size_t i = 0UL; i < N; ++i) {
+		table[i] = entries[i];
+	}
+	return PerfectHashTable<Value, N>(table);
+}
@@ -0,0 +1,118 @@
+#include "prediction_pool.hpp"
+#include <algorithm>
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr size_t MAX_PREDICTION_OUTCOMES = 10UL;  // Twitch allows up to 10 outcomes
+constexpr size_t MAX_TOP_PREDICTORS = 10UL;       // Twitch reports up to 10 top predictors per outcome
+//--------------------------------------------------------------
+PredictionPool::PredictionPool(void)
+	: m_phase(Phase::Idle),
+	  m_prediction_id(),
+	  m_total_users(0UL),
+	  m_total_channel_points(0UL)
+{
+	m_outcomes.reserve(MAX_PREDICTION_OUTCOMES);
+	m_predictors.reserve(MAX_PREDICTION_OUTCOMES * MAX_TOP_PREDICTORS);
+}
+
+// **🔹 Phase Transitions**
+void PredictionPool::begin(std::string_view prediction_id)
+{
+	// `clear()` keeps the allocated capacity, so a new prediction reuses the old storage
+	m_phase = Phase::Open;
+	m_prediction_id.assign(prediction_id);
+	m_total_users = 0UL;
+	m_total_channel_points = 0UL;
+	m_outcomes.clear();
+	m_predictors.clear();
+}
+
+void PredictionPool::lock(void)
+{
+	m_phase = Phase::Locked;
+}
+
+void PredictionPool::end(void)
+{
+	m_phase = Phase::Ended;
+}
+
+bool PredictionPool::is_current(std::string_view prediction_id) const
+{
+	return m_phase != Phase::Idle and m_prediction_id == prediction_id;
+}
+
+PredictionPool::Phase PredictionPool::phase(void) const
+{
+	return m_phase;
+}
+
+std::string_view PredictionPool::prediction_id(void) const
+{
+	return m_prediction_id;
+}
+
+// **🔹 Delta Updates**
+bool PredictionPool::update_outcome(std::string_view outcome_id, size_t users, size_t channel_points)
+{
+	Outcome &outcome = m_outcomes[outcome_index(outcome_id)];
+	if (outcome.users == users and outcome.channel_points == channel_points) {
+		return false;
+	}
+
+	m_total_users = m_total_users - outcome.users + users;
+	m_total_channel_points = m_total_channel_points - outcome.channel_points + channel_points;
+	outcome.users = users;
+	outcome.channel_points = channel_points;
+	return true;
+}
+
+size_t PredictionPool::update_predictor(std::string_view user_id, std::string_view outcome_id,
+					size_t channel_points_used)
+{
+	const size_t outcome = outcome_index(outcome_id);
+
+	auto it = m_predictors.find(user_id);
+	if (it == m_predictors.end()) {
+		m_predictors.emplace(std::string(user_id), Predictor{outcome, channel_points_used});
+		return 0UL;
+	}
+
+	const size_t previous = it->second.channel_points_used;
+	it->second = Predictor{outcome, channel_points_used};
+	return previous;
+}
+
+size_t PredictionPool::total_users(void) const
+{
+	return m_total_users;
+}
+
+size_t PredictionPool::total_channel_points(void) const
+{
+	return m_total_channel_points;
+}
+
+size_t PredictionPool::predictor_count(void) const
+{
+	return m_predictors.size();
+}
+
+const std::vector<PredictionPool::Outcome> &PredictionPool::outcomes(void) const
+{
+	return m_outcomes;
+}
+
+// Outcomes are capped at 10, so a linear scan beats hashing
+size_t PredictionPool::outcome_index(std::string_view outcome_id)
+{
+	auto it = std::find_if(m_outcomes.begin(), m_outcomes.end(),
+			       [outcome_id](const Outcome &outcome) { return outcome.id == outcome_id; });
+	if (it != m_outcomes.end()) {
+		return static_cast<size_t>(std::distance(m_outcomes.begin(), it));
+	}
+
+	m_outcomes.push_back(Outcome{std::string(outcome_id), 0UL, 0UL});
+	return m_outcomes.size() - 1UL;
+}
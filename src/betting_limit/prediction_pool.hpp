@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Running state of the channel's current prediction. Twitch resends the full
+// `outcomes` and `top_predictors` arrays on every progress event; the pool keeps
+// the last reported values and only applies what changed, so totals are never
+// rebuilt from scratch. Not thread-safe: owned by the EventSub io thread.
+class PredictionPool {
+public:
+	enum class Phase : uint8_t { Idle, Open, Locked, Ended };
+
+	struct Outcome {
+		std::string id;
+		size_t users;
+		size_t channel_points;
+	};
+
+	struct Predictor {
+		size_t outcome;
+		size_t channel_points_used;
+	};
+
+	PredictionPool(void);
+
+	void begin(std::string_view prediction_id);
+	void lock(void);
+	void end(void);
+
+	bool is_current(std::string_view prediction_id) const;
+	Phase phase(void) const;
+	std::string_view prediction_id(void) const;
+
+	// Applies an outcome's reported totals. Returns false when nothing changed,
+	// in which case its top predictors are unchanged as well.
+	bool update_outcome(std::string_view outcome_id, size_t users, size_t channel_points);
+
+	// Applies a predictor's reported spend and returns the previously known spend (0 if unseen).
+	size_t update_predictor(std::string_view user_id, std::string_view outcome_id, size_t channel_points_used);
+
+	size_t total_users(void) const;
+	size_t total_channel_points(void) const;
+	size_t predictor_count(void) const;
+	const std::vector<Outcome> &outcomes(void) const;
+
+private:
+	struct TransparentHash {
+		using is_transparent = void;
+		size_t operator()(std::string_view key) const noexcept { return std::hash<std::string_view>{}(key); }
+	};
+
+	size_t outcome_index(std::string_view outcome_id);
+
+	Phase m_phase;
+	std::string m_prediction_id;
+	size_t m_total_users, m_total_channel_points;
+	std::vector<Outcome> m_outcomes;
+	std::unordered_map<std::string, Predictor, TransparentHash, std::equal_to<>> m_predictors;
+};
@@ -0,0 +1,260 @@
+#include "timing_wheel.hpp"
+#include <algorithm>
+#include <utility>
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr uint64_t MAX_TIMEOUT_TICKS = (1ULL << 32) - 1ULL; // 4 levels x 8 bits; ~497 days at 10 ms
+//--------------------------------------------------------------
+// **🔹 Constructor & Destructor**
+TimingWheel::TimingWheel(boost::asio::io_context &io_context, Clock::duration resolution)
+	: m_timer(io_context),
+	  m_resolution(resolution),
+	  m_origin(Clock::now()),
+	  m_current(0UL),
+	  m_size(0UL),
+	  m_deadline(NO_TICK),
+	  m_free(NIL),
+	  m_nodes()
+{
+	m_slots.fill(NIL);
+}
+
+TimingWheel::~TimingWheel(void)
+{
+	m_timer.cancel();
+}
+
+// **🔹 Schedule / Cancel**
+TimingWheel::Handle TimingWheel::schedule(Clock::duration delay, Callback callback)
+{
+	const Clock::time_point now = Clock::now();
+	if (m_size == 0UL) {
+		// Nothing pending: jump straight to the present instead of walking idle ticks later
+		m_current = std::max(m_current, tick_of(now));
+	}
+
+	// Round up so a timeout never fires early, and always at least one tick ahead
+	const uint64_t due = tick_of(now + delay + m_resolution - Clock::duration(1));
+	const uint64_t expiry = std::clamp(due, m_current + 1UL, m_current + MAX_TIMEOUT_TICKS);
+
+	const uint32_t index = allocate();
+	Node &node = m_nodes[index];
+	node.expiry = expiry;
+	node.callback = std::move(callback);
+	link(index);
+	++m_size;
+
+	// Anything due at or after the armed deadline is picked up when the timer fires
+	if (expiry < m_deadline) {
+		arm();
+	}
+	return Handle{index, node.generation};
+}
+
+bool TimingWheel::cancel(Handle &handle)
+{
+	if (!pending(handle)) {
+		handle = Handle{};
+		return false;
+	}
+
+	unlink(handle.index);
+	release(handle.index);
+	--m_size;
+	handle = Handle{};
+	if (m_size == 0UL) {
+		arm(); // disarms
+	}
+	return true;
+}
+
+bool TimingWheel::pending(const Handle &handle) const
+{
+	return handle.index < m_nodes.size() and m_nodes[handle.index].generation == handle.generation and
+	       m_nodes[handle.index].slot != NIL;
+}
+
+size_t TimingWheel::size(void) const
+{
+	return m_size;
+}
+
+void TimingWheel::clear(void)
+{
+	for (uint32_t index = 0U; index < m_nodes.size(); ++index) {
+		if (m_nodes[index].slot != NIL) {
+			unlink(index);
+			release(index);
+		}
+	}
+	m_size = 0UL;
+	arm();
+}
+
+// **🔹 Advance**
+void TimingWheel::advance(Clock::time_point now)
+{
+	const uint64_t target = tick_of(now);
+	while (m_current < target) {
+		if (m_size == 0UL) {
+			m_current = target;
+			break;
+		}
+
+		++m_current;
+		const size_t slot = static_cast<size_t>(m_current & SLOT_MASK);
+
+		// Level 0 wrapped: pull the next slot of each higher level down, stopping at the first that did not wrap
+		if (slot == 0UL) {
+			for (size_t level = 1UL; level < LEVELS; ++level) {
+				const size_t level_slot = static_cast<size_t>((m_current >> (level * SLOT_BITS)) & SLOT_MASK);
+				cascade(level, level_slot);
+				if (level_slot != 0UL) {
+					break;
+				}
+			}
+		}
+
+		fire(slot);
+	}
+}
+
+// **🔹 Node Pool**
+uint64_t TimingWheel::tick_of(Clock::time_point time) const
+{
+	return time <= m_origin ? 0UL : static_cast<uint64_t>((time - m_origin) / m_resolution);
+}
+
+uint32_t TimingWheel::allocate(void)
+{
+	if (m_free != NIL) {
+		const uint32_t index = m_free;
+		m_free = m_nodes[index].next;
+		return index;
+	}
+
+	m_nodes.push_back(Node{0UL, NIL, NIL, 0U, NIL, Callback()});
+	return static_cast<uint32_t>(m_nodes.size() - 1UL);
+}
+
+void TimingWheel::release(uint32_t index)
+{
+	Node &node = m_nodes[index];
+	node.callback = nullptr;
+	node.slot = NIL;
+	++node.generation; // invalidates outstanding handles
+	node.prev = NIL;
+	node.next = m_free;
+	m_free = index;
+}
+
+// **🔹 Slot Lists**
+void TimingWheel::link(uint32_t index)
+{
+	Node &node = m_nodes[index];
+	const uint64_t delta = node.expiry - m_current;
+
+	size_t level = 0UL;
+	while (level + 1UL < LEVELS and delta >= (1ULL << ((level + 1UL) * SLOT_BITS))) {
+		++level;
+	}
+
+	node.slot = static_cast<uint32_t>(level * SLOTS + ((node.expiry >> (level * SLOT_BITS)) & SLOT_MASK));
+	node.prev = NIL;
+	node.next = m_slots[node.slot];
+	if (node.next != NIL) {
+		m_nodes[node.next].prev = index;
+	}
+	m_slots[node.slot] = index;
+}
+
+void TimingWheel::unlink(uint32_t index)
+{
+	Node &node = m_nodes[index];
+	if (node.prev != NIL) {
+		m_nodes[node.prev].next = node.next;
+	} else {
+		m_slots[node.slot] = node.next;
+	}
+	if (node.next != NIL) {
+		m_nodes[node.next].prev = node.prev;
+	}
+	node.prev = NIL;
+	node.next = NIL;
+}
+
+void TimingWheel::cascade(size_t level, size_t slot)
+{
+	uint32_t index = std::exchange(m_slots[level * SLOTS + slot], NIL);
+	while (index != NIL) {
+		const uint32_t next = m_nodes[index].next;
+		link(index);
+		index = next;
+	}
+}
+
+void TimingWheel::fire(size_t slot)
+{
+	// Pop one at a time: callbacks may schedule or cancel, which can grow `m_nodes`
+	while (m_slots[slot] != NIL) {
+		const uint32_t index = m_slots[slot];
+		unlink(index);
+		Callback callback = std::move(m_nodes[index].callback);
+		release(index);
+		--m_size;
+		if (callback) {
+			callback();
+		}
+	}
+}
+
+// **🔹 Asio Driver**
+// Level-0 entries are all due within the next SLOTS ticks, one tick per slot, so the first
+// occupied slot ahead is the next expiry. Higher levels only move down when level 0 wraps.
+uint64_t TimingWheel::next_due(void) const
+{
+	uint64_t due = NO_TICK;
+	for (uint64_t tick = m_current + 1UL; tick < m_current + SLOTS; ++tick) {
+		if (m_slots[tick & SLOT_MASK] != NIL) {
+			due = tick;
+			break;
+		}
+	}
+
+	const uint64_t wrap = (m_current | SLOT_MASK) + 1UL;
+	if (due > wrap and std::any_of(m_slots.begin() + SLOTS, m_slots.end(),
+				       [](uint32_t index) { return index != NIL; })) {
+		due = wrap;
+	}
+	return due;
+}
+
+void TimingWheel::arm(void)
+{
+	const uint64_t due = next_due();
+	if (due == m_deadline) {
+		return;
+	}
+
+	m_deadline = due;
+	if (due == NO_TICK) {
+		m_timer.cancel();
+		return;
+	}
+
+	// Replaces (and aborts) a later wait that is still pending
+	m_timer.expires_at(m_origin + m_resolution * static_cast<Clock::rep>(due));
+	m_timer.async_wait([this](const boost::system::error_code &ec) { this->on_timer(ec); });
+}
+
+void TimingWheel::on_timer(const boost::system::error_code &ec)
+{
+	if (ec) {
+		return; // Re-armed or disarmed; whoever did it already updated `m_deadline`
+	}
+
+	m_deadline = NO_TICK;
+	advance(Clock::now());
+	arm();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/system/error_code.hpp>
+
+// Hashed hierarchical timing wheel (4 levels x 256 slots) driven by a single steady_timer.
+// Timeouts live in a pooled array linked by index, so schedule and cancel are O(1). The
+// Asio timer is armed for the next occupied slot (or the next cascade) rather than every
+// tick, and not at all while the wheel is empty. Must only be used from the thread
+// running the io_context it was constructed with.
+class TimingWheel {
+public:
+	using Clock = std::chrono::steady_clock;
+	using Callback = std::function<void(void)>;
+
+	struct Handle {
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0U;
+	};
+
+	explicit TimingWheel(boost::asio::io_context &io_context,
+			     Clock::duration resolution = std::chrono::milliseconds(10));
+	~TimingWheel(void);
+	TimingWheel(const TimingWheel &) = delete;
+	TimingWheel(TimingWheel &&) = delete;
+	TimingWheel &operator=(const TimingWheel &) = delete;
+	TimingWheel &operator=(TimingWheel &&) = delete;
+
+	Handle schedule(Clock::duration delay, Callback callback);
+	bool cancel(Handle &handle);
+	bool pending(const Handle &handle) const;
+	size_t size(void) const;
+	void clear(void);
+
+	// Fires everything due by `now`; normally called by the internal timer
+	void advance(Clock::time_point now);
+
+private:
+	static constexpr size_t LEVELS = 4UL;
+	static constexpr size_t SLOT_BITS = 8UL;
+	static constexpr size_t SLOTS = 1UL << SLOT_BITS;
+	static constexpr uint64_t SLOT_MASK = SLOTS - 1UL;
+	static constexpr uint32_t NIL = UINT32_MAX;
+	static constexpr uint64_t NO_TICK = UINT64_MAX;
+
+	struct Node {
+		uint64_t expiry;
+		uint32_t prev, next;
+		uint32_t generation;
+		uint32_t slot;
+		Callback callback;
+	};
+
+	uint64_t tick_of(Clock::time_point time) const;
+	uint32_t allocate(void);
+	void release(uint32_t index);
+	void link(uint32_t index);
+	void unlink(uint32_t index);
+	void cascade(size_t level, size_t slot);
+	void fire(size_t slot);
+	uint64_t next_due(void) const;
+	void arm(void);
+	void on_timer(const boost::system::error_code &ec);
+
+	boost::asio::steady_timer m_timer;
+	const Clock::duration m_resolution;
+	const Clock::time_point m_origin;
+	uint64_t m_current;
+	size_t m_size;
+	uint64_t m_deadline; // tick the timer is armed for, NO_TICK when idle
+	uint32_t m_free;
+	std::vector<Node> m_nodes;
+	std::array<uint32_t, LEVELS * SLOTS> m_slots;
+};
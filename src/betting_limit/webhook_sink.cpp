@@ -0,0 +1,723 @@
+#include "webhook_sink.hpp"
+#include "metrics.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <boost/asio/post.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include "logger.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr std::string_view WEBHOOK_SCHEME = "http://";
+constexpr std::string_view WEBHOOK_DEFAULT_PORT = "80";
+constexpr std::string_view WEBHOOK_LOOPBACK_NAME = "localhost";
+constexpr std::string_view WEBHOOK_CONTENT_TYPE = "application/x-ndjson";
+constexpr std::string_view WEBHOOK_USER_AGENT = "twitch-limiter-webhook";
+constexpr size_t FLUSH_BATCH_EVENTS = 500UL;      // a flush is requested once the open batch reaches either size
+constexpr size_t FLUSH_BATCH_BYTES = 64UL * 1024UL;
+constexpr size_t SPILL_CHUNK_BYTES = 256UL * 1024UL; // replayed per request
+constexpr size_t BATCH_RESERVE = 16UL * 1024UL;
+constexpr size_t MAX_QUEUED_BYTES = 4UL * 1024UL * 1024UL;   // per endpoint in memory; beyond this batches spill
+constexpr uint64_t MAX_SPILL_BYTES = 64UL * 1024UL * 1024UL; // per endpoint on disk; beyond this events are dropped
+constexpr auto FLUSH_INTERVAL = std::chrono::seconds(1);
+constexpr auto CONNECT_TIMEOUT = std::chrono::seconds(5);
+constexpr auto REQUEST_TIMEOUT = std::chrono::seconds(10);
+constexpr auto MIN_RETRY_DELAY = std::chrono::seconds(1);
+constexpr auto MAX_RETRY_DELAY = std::chrono::seconds(60);
+//--------------------------------------------------------------
+// Events go out unencrypted, so by default they must not leave the machine; other names could resolve anywhere
+static bool is_loopback_host(std::string_view host)
+{
+	if (host == WEBHOOK_LOOPBACK_NAME) {
+		return true;
+	}
+	boost::system::error_code ec;
+	const boost::asio::ip::address address = boost::asio::ip::make_address(std::string(host), ec);
+	return !ec and address.is_loopback();
+}
+
+// **🔹 NDJSON Helpers**
+static void append_json_string(std::string &out, std::string_view text)
+{
+	static constexpr char HEX[] = "0123456789abcdef";
+	out.push_back('"');
+	for (const char c : text) {
+		const auto byte = static_cast<unsigned char>(c);
+		if (c == '"' or c == '\\') {
+			out.push_back('\\');
+			out.push_back(c);
+		} else if (byte < 0x20U) {
+			out.append("\\u00");
+			out.push_back(HEX[byte >> 4U]);
+			out.push_back(HEX[byte & 0x0FU]);
+		} else {
+			out.push_back(c);
+		}
+	}
+	out.push_back('"');
+}
+
+static void append_json_number(std::string &out, std::string_view key, uint64_t value)
+{
+	char digits[20];
+	const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+	out.append(",\"").append(key).append("\":").append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+static void append_event(std::string &out, const WebhookSink::Event &event, uint64_t timestamp_ms)
+{
+	out.append(event.kind == WebhookSink::EventKind::Breach ? "{\"type\":\"breach\"" : "{\"type\":\"redemption\"");
+	append_json_number(out, "ts", timestamp_ms);
+	out.append(",\"user\":");
+	append_json_string(out, event.user);
+	out.append(",\"reward\":");
+	append_json_string(out, event.reward);
+	append_json_number(out, "amount", event.amount);
+	append_json_number(out, "previous_amount", event.previous_amount);
+	if (event.limit == std::numeric_limits<uint64_t>::max()) {
+		out.append(",\"limit\":null"); // limit disabled
+	} else {
+		append_json_number(out, "limit", event.limit);
+	}
+	if (event.kind == WebhookSink::EventKind::Breach) {
+		out.append(event.suppressed ? ",\"suppressed\":true" : ",\"suppressed\":false");
+	}
+	out.append("}\n");
+}
+
+// FNV-1a, stable across runs so an endpoint finds its spill file again after a restart
+static std::string spill_file_name(std::string_view url)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (const char c : url) {
+		hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+	}
+
+	char name[40];
+	std::snprintf(name, sizeof(name), "webhook-%016llx.ndjson", static_cast<unsigned long long>(hash));
+	return name;
+}
+//--------------------------------------------------------------
+// **🔹 Endpoint**
+// One URL with its connection, in-memory queue, spill file and retry state; sink thread only.
+// The memory queue is only used while the spill file is empty. Spilling always starts with
+// the batch in flight and then the queue, and once the file has data every later batch is
+// appended behind it, so events are delivered in the order they were published.
+class WebhookSink::Endpoint : public std::enable_shared_from_this<Endpoint> {
+public:
+	Endpoint(boost::asio::io_context &io_context, std::atomic<size_t> &pending, std::string url, Url parts,
+		 std::filesystem::path spill_path)
+		: m_url(std::move(url)),
+		  m_parts(std::move(parts)),
+		  m_spill_path(std::move(spill_path)),
+		  m_resolver(io_context),
+		  m_stream(io_context),
+		  m_retry_timer(io_context),
+		  m_buffer(),
+		  m_request(),
+		  m_response(),
+		  m_queue(),
+		  m_queued_bytes(0UL),
+		  m_spill_offset(0UL),
+		  m_spill_size(0UL),
+		  m_spill_events(0UL),
+		  m_in_flight(Source::None),
+		  m_in_flight_events(0UL),
+		  m_in_flight_end(0UL),
+		  m_busy(false),
+		  m_backing_off(false),
+		  m_closed(false),
+		  m_reused_connection(false),
+		  m_dropping(false),
+		  m_failures(0UL),
+		  m_pending(pending)
+	{
+		const bool bracketed = m_parts.host.find(':') != std::string::npos; // IPv6 literal
+		m_host_header = bracketed ? "[" + m_parts.host + "]" : m_parts.host;
+		if (m_parts.port != WEBHOOK_DEFAULT_PORT) {
+			m_host_header.append(":").append(m_parts.port);
+		}
+	}
+
+	// Picks up events spilled by a previous run
+	void open(void)
+	{
+		std::error_code ec;
+		const uint64_t size = std::filesystem::file_size(m_spill_path, ec);
+		if (!ec and size > 0UL) {
+			std::ifstream in(m_spill_path, std::ios::binary);
+			std::string block(SPILL_CHUNK_BYTES, '\0');
+			size_t events = 0UL;
+			while (in.read(block.data(), static_cast<std::streamsize>(block.size())) or in.gcount() > 0) {
+				events += static_cast<size_t>(
+					std::count(block.data(), block.data() + in.gcount(), '\n'));
+			}
+			m_spill_size = size;
+			m_spill_events = events;
+			m_pending.fetch_add(events);
+			log_message(LogLevel::Info, "Webhook %s: replaying %zu spilled events", m_url.c_str(), events);
+		}
+		send_next();
+	}
+
+	void enqueue(const std::shared_ptr<const Batch> &batch)
+	{
+		m_pending.fetch_add(batch->events);
+		if (m_backing_off or spilled() or m_queued_bytes + batch->lines.size() > MAX_QUEUED_BYTES) {
+			spill_queue();
+			spill(batch->lines, batch->events);
+		} else {
+			m_queue.push_back(batch);
+			m_queued_bytes += batch->lines.size();
+		}
+		send_next();
+	}
+
+	// Nothing is lost on shutdown: the batch in flight and the memory queue go to the spill file
+	void close(void)
+	{
+		m_closed = true;
+		m_retry_timer.cancel();
+		m_resolver.cancel();
+		m_stream.close();
+		spill_queue();
+	}
+
+private:
+	enum class Source : uint8_t { None, Queue, Spill };
+
+	bool spilled(void) const { return m_spill_offset < m_spill_size; }
+
+	// **🔹 Request Cycle**
+	void send_next(void)
+	{
+		if (m_closed or m_busy or m_backing_off) {
+			return;
+		}
+
+		while (m_in_flight == Source::None and spilled()) {
+			load_spill_chunk();
+		}
+		if (m_in_flight == Source::None) {
+			if (m_queue.empty()) {
+				return;
+			}
+			m_request.body() = m_queue.front()->lines;
+			m_in_flight_events = m_queue.front()->events;
+			m_in_flight = Source::Queue;
+			m_queued_bytes -= m_queue.front()->lines.size();
+			m_queue.pop_front();
+		}
+
+		m_busy = true;
+		if (m_stream.socket().is_open()) {
+			write(true);
+		} else {
+			connect();
+		}
+	}
+
+	void connect(void)
+	{
+		m_buffer.clear();
+		m_resolver.async_resolve(
+			m_parts.host, m_parts.port,
+			[self = shared_from_this()](const boost::system::error_code &ec,
+						    boost::asio::ip::tcp::resolver::results_type results) {
+				if (self->m_closed) {
+					return;
+				}
+				if (ec) {
+					self->fail("resolve failed: " + ec.message());
+					return;
+				}
+
+				self->m_stream.expires_after(CONNECT_TIMEOUT);
+				self->m_stream.async_connect(
+					results, [self](const boost::system::error_code &ec,
+							const boost::asio::ip::tcp::endpoint &) {
+						if (self->m_closed) {
+							return;
+						}
+						if (ec) {
+							self->fail("connect failed: " + ec.message());
+							return;
+						}
+						self->m_stream.socket().set_option(
+							boost::asio::ip::tcp::no_delay(true));
+						self->write(false);
+					});
+			});
+	}
+
+	void write(bool reused_connection)
+	{
+		m_reused_connection = reused_connection;
+		m_request.method(boost::beast::http::verb::post);
+		m_request.target(m_parts.target);
+		m_request.version(11);
+		m_request.set(boost::beast::http::field::host, m_host_header);
+		m_request.set(boost::beast::http::field::user_agent, WEBHOOK_USER_AGENT.data());
+		m_request.set(boost::beast::http::field::content_type, WEBHOOK_CONTENT_TYPE.data());
+		m_request.keep_alive(true);
+		m_request.prepare_payload();
+		m_response = {};
+
+		m_stream.expires_after(REQUEST_TIMEOUT);
+		boost::beast::http::async_write(
+			m_stream, m_request,
+			[self = shared_from_this()](const boost::system::error_code &ec, size_t) {
+				if (self->m_closed) {
+					return;
+				}
+				if (ec) {
+					self->retry_or_fail("send failed: " + ec.message());
+					return;
+				}
+
+				boost::beast::http::async_read(self->m_stream, self->m_buffer, self->m_response,
+							       [self](const boost::system::error_code &ec, size_t) {
+								       if (!self->m_closed) {
+									       self->handle_response(ec);
+								       }
+							       });
+			});
+	}
+
+	void handle_response(const boost::system::error_code &ec)
+	{
+		if (ec) {
+			retry_or_fail("no response: " + ec.message());
+			return;
+		}
+
+		const unsigned status = m_response.result_int();
+		if (status >= 200U and status < 300U) {
+			complete_in_flight();
+			m_failures = 0UL;
+			m_dropping = false;
+			Metrics::instance().increment(Metrics::Counter::WebhookBatches);
+		} else if (status >= 400U and status < 500U and status != 408U and status != 429U) {
+			// The endpoint will never accept this batch; retrying would block everything behind it
+			drop(m_in_flight_events, "rejected with HTTP " + std::to_string(status));
+			complete_in_flight();
+		} else {
+			fail("HTTP " + std::to_string(status));
+			return;
+		}
+
+		if (!m_response.keep_alive()) {
+			m_stream.close();
+		}
+		m_busy = false;
+		send_next();
+	}
+
+	// A kept-alive connection may have been closed by the server while idle; that is not an outage
+	void retry_or_fail(const std::string &reason)
+	{
+		if (!m_reused_connection) {
+			fail(reason);
+			return;
+		}
+		m_stream.close();
+		connect();
+	}
+
+	void fail(const std::string &reason)
+	{
+		m_stream.close();
+		m_busy = false;
+		m_backing_off = true;
+		spill_queue(); // later batches wait behind the spill file
+
+		const auto delay =
+			std::min<std::chrono::seconds>(MIN_RETRY_DELAY * (1L << std::min<size_t>(m_failures, 6UL)),
+						       MAX_RETRY_DELAY);
+		++m_failures;
+		log_message(LogLevel::Warning, "Webhook %s: %s; retrying in %lld seconds (%zu events spilled)",
+			    m_url.c_str(), reason.c_str(), static_cast<long long>(delay.count()), m_spill_events);
+
+		m_retry_timer.expires_after(delay);
+		m_retry_timer.async_wait([self = shared_from_this()](const boost::system::error_code &ec) {
+			if (ec or self->m_closed) {
+				return;
+			}
+			self->m_backing_off = false;
+			self->send_next();
+		});
+	}
+
+	void complete_in_flight(void)
+	{
+		m_pending.fetch_sub(m_in_flight_events);
+		if (m_in_flight == Source::Spill) {
+			m_spill_offset = m_in_flight_end;
+			m_spill_events -= m_in_flight_events;
+			if (!spilled()) {
+				clear_spill();
+			}
+		}
+		m_in_flight = Source::None;
+		m_in_flight_events = 0UL;
+		m_request.body().clear();
+	}
+
+	// **🔹 Spill File**
+	bool spill(std::string_view lines, size_t events)
+	{
+		if (m_spill_size + lines.size() > MAX_SPILL_BYTES) {
+			m_pending.fetch_sub(events);
+			drop(events, "spill file is full");
+			return false;
+		}
+
+		std::error_code ec;
+		std::filesystem::create_directories(m_spill_path.parent_path(), ec);
+		std::ofstream out(m_spill_path, std::ios::binary | std::ios::app);
+		out.write(lines.data(), static_cast<std::streamsize>(lines.size()));
+		out.close();
+		if (!out) {
+			m_pending.fetch_sub(events);
+			drop(events, "cannot write " + m_spill_path.string());
+			return false;
+		}
+
+		m_spill_size += lines.size();
+		m_spill_events += events;
+		return true;
+	}
+
+	void spill_queue(void)
+	{
+		// The file is empty while the queue is in use, so the batch in flight becomes its first chunk
+		if (m_in_flight == Source::Queue) {
+			const uint64_t start = m_spill_size;
+			if (spill(m_request.body(), m_in_flight_events)) {
+				m_in_flight = Source::Spill;
+				m_in_flight_end = start + m_request.body().size();
+			} else {
+				m_in_flight = Source::None; // dropped
+				m_in_flight_events = 0UL;
+			}
+		}
+		for (const std::shared_ptr<const Batch> &batch : m_queue) {
+			spill(batch->lines, batch->events);
+		}
+		m_queue.clear();
+		m_queued_bytes = 0UL;
+	}
+
+	// Reads whole lines from the spill offset into the request body
+	void load_spill_chunk(void)
+	{
+		std::string &body = m_request.body();
+		std::ifstream in(m_spill_path, std::ios::binary);
+		in.seekg(static_cast<std::streamoff>(m_spill_offset));
+		body.resize(static_cast<size_t>(std::min<uint64_t>(SPILL_CHUNK_BYTES, m_spill_size - m_spill_offset)));
+		in.read(body.data(), static_cast<std::streamsize>(body.size()));
+		body.resize(static_cast<size_t>(std::max<std::streamsize>(in.gcount(), 0)));
+		if (body.empty()) {
+			log_message(LogLevel::Warning, "Webhook %s: spill file %s disappeared", m_url.c_str(),
+				    m_spill_path.string().c_str());
+			m_pending.fetch_sub(m_spill_events);
+			clear_spill();
+			return;
+		}
+
+		const size_t end = body.rfind('\n');
+		if (end == std::string::npos) {
+			// Only a tail cut off by a crash lacks a newline; events are far shorter than a chunk
+			drop(1UL, "incomplete line at the end of the spill file");
+			m_pending.fetch_sub(m_spill_events);
+			body.clear();
+			clear_spill();
+			return;
+		}
+
+		body.resize(end + 1UL);
+		m_in_flight = Source::Spill;
+		m_in_flight_events = static_cast<size_t>(std::count(body.begin(), body.end(), '\n'));
+		m_in_flight_end = m_spill_offset + body.size();
+	}
+
+	void clear_spill(void)
+	{
+		std::error_code ec;
+		std::filesystem::remove(m_spill_path, ec);
+		m_spill_offset = 0UL;
+		m_spill_size = 0UL;
+		m_spill_events = 0UL;
+	}
+
+	// Callers settle m_pending; this only accounts for the loss
+	void drop(size_t events, const std::string &reason)
+	{
+		Metrics::instance().increment(Metrics::Counter::WebhookDropped, events);
+		if (!m_dropping) {
+			m_dropping = true; // once per outage
+			log_message(LogLevel::Warning, "Webhook %s: dropping events (%s)", m_url.c_str(),
+				    reason.c_str());
+		}
+	}
+
+	std::string m_url, m_host_header;
+	Url m_parts;
+	std::filesystem::path m_spill_path;
+	boost::asio::ip::tcp::resolver m_resolver;
+	boost::beast::tcp_stream m_stream;
+	boost::asio::steady_timer m_retry_timer;
+	boost::beast::flat_buffer m_buffer;
+	boost::beast::http::request<boost::beast::http::string_body> m_request;
+	boost::beast::http::response<boost::beast::http::string_body> m_response;
+	std::deque<std::shared_ptr<const Batch>> m_queue;
+	size_t m_queued_bytes;
+	uint64_t m_spill_offset, m_spill_size;
+	size_t m_spill_events;
+	Source m_in_flight;
+	size_t m_in_flight_events;
+	uint64_t m_in_flight_end;
+	bool m_busy, m_backing_off, m_closed, m_reused_connection, m_dropping;
+	size_t m_failures;
+	std::atomic<size_t> &m_pending;
+};
+//--------------------------------------------------------------
+// **🔹 Constructor & Destructor**
+WebhookSink::WebhookSink(void)
+	: m_urls(),
+	  m_spill_directory(),
+	  m_batch(),
+	  m_batch_events(0UL),
+	  m_active(false),
+	  m_flush_requested(false),
+	  m_pending(0UL),
+	  m_io_context(),
+	  m_flush_timer(m_io_context),
+	  m_endpoints(),
+	  m_thread()
+{
+	Metrics::instance().register_queue_depth("webhook_sink", [this]() { return pending(); });
+}
+
+WebhookSink::~WebhookSink(void)
+{
+	stop();
+}
+
+// **🔹 Configuration**
+bool WebhookSink::configure(const std::vector<std::string> &urls, const std::filesystem::path &spill_directory,
+			    bool allow_remote)
+{
+	std::lock_guard<std::mutex> lock(m_config_mutex);
+
+	bool valid = true;
+	std::vector<std::string> accepted, remote_urls;
+	std::vector<std::shared_ptr<Endpoint>> endpoints;
+	for (const std::string &url : urls) {
+		std::optional<Url> parts = parse_url(url);
+		if (!parts) {
+			log_message(LogLevel::Warning, "Ignoring webhook URL (expected http://host[:port]/path): %s",
+				    url.c_str());
+			valid = false;
+			continue;
+		}
+		const bool remote = !is_loopback_host(parts->host);
+		if (remote and !allow_remote) {
+			log_message(LogLevel::Warning,
+				    "Ignoring webhook URL (unencrypted, so only localhost, 127.0.0.1 or [::1] unless "
+				    "other hosts are allowed): %s",
+				    url.c_str());
+			valid = false;
+			continue;
+		}
+		if (std::find(accepted.begin(), accepted.end(), url) != accepted.end()) {
+			continue;
+		}
+		if (remote) {
+			remote_urls.push_back(url);
+		}
+		accepted.push_back(url);
+		endpoints.push_back(std::make_shared<Endpoint>(m_io_context, m_pending, url, std::move(parts.value()),
+							       spill_directory / spill_file_name(url)));
+	}
+
+	if (accepted == m_urls and spill_directory == m_spill_directory) {
+		return valid;
+	}
+
+	stop();
+	m_urls = std::move(accepted);
+	m_spill_directory = spill_directory;
+	if (endpoints.empty()) {
+		log_message(LogLevel::Info, "Webhook sink disabled.");
+		return valid;
+	}
+
+	log_message(LogLevel::Info, "Webhook sink posting to %zu endpoint(s), spilling to %s", endpoints.size(),
+		    m_spill_directory.string().c_str());
+	for (const std::string &url : remote_urls) {
+		log_message(LogLevel::Warning, "Webhook %s is on another host; events are sent unencrypted",
+			    url.c_str());
+	}
+	start(std::move(endpoints));
+	return valid;
+}
+
+std::optional<WebhookSink::Url> WebhookSink::parse_url(std::string_view url)
+{
+	if (!url.starts_with(WEBHOOK_SCHEME)) {
+		return std::nullopt;
+	}
+	url.remove_prefix(WEBHOOK_SCHEME.size());
+
+	const size_t slash = url.find('/');
+	const std::string_view authority = url.substr(0, slash);
+	const std::string_view target = slash == std::string_view::npos ? std::string_view("/") : url.substr(slash);
+	if (authority.empty() or authority.find('@') != std::string_view::npos) {
+		return std::nullopt;
+	}
+
+	std::string_view host = authority, port = WEBHOOK_DEFAULT_PORT;
+	if (authority.front() == '[') {
+		const size_t close = authority.find(']');
+		if (close == std::string_view::npos) {
+			return std::nullopt;
+		}
+		host = authority.substr(1, close - 1UL);
+		const std::string_view rest = authority.substr(close + 1UL);
+		if (!rest.empty()) {
+			if (rest.front() != ':') {
+				return std::nullopt;
+			}
+			port = rest.substr(1);
+		}
+	} else if (const size_t colon = authority.rfind(':'); colon != std::string_view::npos) {
+		host = authority.substr(0, colon);
+		port = authority.substr(colon + 1UL);
+	}
+
+	unsigned number = 0U;
+	const auto result = std::from_chars(port.data(), port.data() + port.size(), number);
+	if (host.empty() or result.ec != std::errc() or result.ptr != port.data() + port.size() or number == 0U or
+	    number > 65535U) {
+		return std::nullopt;
+	}
+	return Url{std::string(host), std::string(port), std::string(target)};
+}
+
+// **🔹 Worker Thread**
+void WebhookSink::start(std::vector<std::shared_ptr<Endpoint>> endpoints)
+{
+	m_io_context.restart();
+	m_work_guard.emplace(m_io_context.get_executor());
+	m_endpoints = std::move(endpoints);
+	for (const std::shared_ptr<Endpoint> &endpoint : m_endpoints) {
+		boost::asio::post(m_io_context, [endpoint]() { endpoint->open(); });
+	}
+	arm_flush_timer();
+
+	m_active.store(true);
+	m_thread = std::thread([this]() { m_io_context.run(); });
+}
+
+// The open batch and everything undelivered is spilled; the thread exits once the
+// cancelled operations have completed
+void WebhookSink::stop(void)
+{
+	if (!m_thread.joinable()) {
+		return;
+	}
+
+	{
+		// A publish() that saw the sink active has appended before this, so the final flush sends it
+		std::lock_guard<std::mutex> lock(m_batch_mutex);
+		m_active.store(false);
+	}
+	boost::asio::post(m_io_context, [this]() {
+		flush();
+		m_flush_timer.cancel();
+		for (const std::shared_ptr<Endpoint> &endpoint : m_endpoints) {
+			endpoint->close();
+		}
+		m_endpoints.clear();
+	});
+	m_work_guard.reset();
+	m_thread.join();
+
+	m_flush_requested.store(false);
+	m_pending.store(0UL); // spilled events are counted again when their endpoint is reopened
+}
+
+void WebhookSink::arm_flush_timer(void)
+{
+	m_flush_timer.expires_after(FLUSH_INTERVAL);
+	m_flush_timer.async_wait([this](const boost::system::error_code &ec) {
+		if (ec) {
+			return;
+		}
+		flush();
+		arm_flush_timer();
+	});
+}
+
+void WebhookSink::flush(void)
+{
+	std::string lines;
+	lines.reserve(BATCH_RESERVE); // for the publishers, allocated outside the lock
+	size_t events = 0UL;
+	{
+		std::lock_guard<std::mutex> lock(m_batch_mutex);
+		lines.swap(m_batch);
+		std::swap(events, m_batch_events);
+	}
+	m_flush_requested.store(false);
+	if (events == 0UL) {
+		return;
+	}
+
+	m_pending.fetch_sub(events);
+	const auto batch = std::make_shared<const Batch>(Batch{std::move(lines), events});
+	for (const std::shared_ptr<Endpoint> &endpoint : m_endpoints) {
+		endpoint->enqueue(batch);
+	}
+}
+
+// **🔹 Publish (EventSub io thread)**
+void WebhookSink::publish(const Event &event)
+{
+	if (!m_active.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	const auto timestamp_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+								std::chrono::system_clock::now().time_since_epoch())
+								.count());
+	bool full = false;
+	{
+		// Re-checked under the lock: stop() clears it under the same lock before its final flush
+		std::lock_guard<std::mutex> lock(m_batch_mutex);
+		if (!m_active.load(std::memory_order_relaxed)) {
+			return;
+		}
+		append_event(m_batch, event, timestamp_ms);
+		++m_batch_events;
+		m_pending.fetch_add(1UL, std::memory_order_relaxed);
+		full = m_batch_events >= FLUSH_BATCH_EVENTS or m_batch.size() >= FLUSH_BATCH_BYTES;
+	}
+
+	if (full and !m_flush_requested.exchange(true)) {
+		boost::asio::post(m_io_context, [this]() { flush(); });
+	}
+}
+
+size_t WebhookSink::pending(void) const
+{
+	return m_pending.load(std::memory_order_relaxed);
+}
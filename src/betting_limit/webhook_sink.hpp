@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+
+#include "bet_sink.hpp"
+
+// Outbound webhook for moderation bots and dashboards. Redemption and breach events are
+// batched as NDJSON and POSTed to one or more plain-HTTP endpoints (loopback only unless
+// other hosts are explicitly allowed, since nothing is encrypted) from the sink's own
+// thread; `publish` only appends a line to the open batch under a short lock, so a slow
+// or dead endpoint never reaches the EventSub read loop. A batch is flushed when it is
+// full or on the next FLUSH_INTERVAL tick. Each endpoint keeps one persistent
+// connection and retries with exponential backoff; while it is failing, its batches go
+// to a spill file that is replayed in order once it recovers (at-least-once delivery).
+class WebhookSink : public BetSink {
+public:
+	struct Url {
+		std::string host, port, target;
+	};
+
+	WebhookSink(void);
+	~WebhookSink(void);
+	WebhookSink(const WebhookSink &) = delete;
+	WebhookSink(WebhookSink &&) = delete;
+	WebhookSink &operator=(const WebhookSink &) = delete;
+	WebhookSink &operator=(WebhookSink &&) = delete;
+
+	// Any thread except the sink's own. Replaces the endpoint list, restarting the worker if it
+	// changed; an empty list stops it. Invalid URLs, and other hosts than this machine unless
+	// `allow_remote`, are logged and skipped (returns false).
+	bool configure(const std::vector<std::string> &urls, const std::filesystem::path &spill_directory,
+		       bool allow_remote = false);
+
+	// Any thread; a no-op while no endpoint is configured
+	void publish(const Event &event) override;
+
+	// Events not yet delivered, counted once per endpoint
+	size_t pending(void) const;
+
+	static std::optional<Url> parse_url(std::string_view url);
+
+private:
+	struct Batch {
+		std::string lines;
+		size_t events;
+	};
+
+	class Endpoint;
+
+	void start(std::vector<std::shared_ptr<Endpoint>> endpoints);
+	void stop(void);
+	void arm_flush_timer(void);
+	void flush(void);
+
+	std::mutex m_config_mutex; // serializes configure()
+	std::vector<std::string> m_urls;
+	std::filesystem::path m_spill_directory;
+
+	std::mutex m_batch_mutex;
+	std::string m_batch;
+	size_t m_batch_events;
+	std::atomic<bool> m_active, m_flush_requested;
+	std::atomic<size_t> m_pending;
+
+	boost::asio::io_context m_io_context;
+	std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> m_work_guard;
+	boost::asio::steady_timer m_flush_timer;
+	std::vector<std::shared_ptr<Endpoint>> m_endpoints; // sink thread only
+	std::thread m_thread;
+};
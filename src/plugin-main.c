@@ -23,6 +23,7 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 bool obs_module_load(void);
 void obs_module_unload(void);
 obs_properties_t *obs_module_get_settings(void *data);
+void obs_module_get_defaults(obs_data_t *settings);
 void obs_module_update_settings(obs_data_t *settings);
 
 OBS_DECLARE_MODULE()
@@ -43,6 +44,11 @@ obs_properties_t *obs_module_get_settings(void *data)
 	return TwitchLimiter_get_settings(data);
 }
 
+void obs_module_get_defaults(obs_data_t *settings)
+{
+	TwitchLimiter_get_defaults(settings);
+}
+
 void obs_module_update_settings(obs_data_t *settings)
 {
 	TwitchLimiter_update_settings(settings);
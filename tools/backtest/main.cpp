@@ -0,0 +1,136 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "logger.hpp"
+#include "policy_backtest.hpp"
+#include "redemption_history.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr std::string_view DEFAULT_LIMITS = "1000:20000:1000";
+constexpr std::string_view DEFAULT_TIMEOUTS = "10,30,60";
+constexpr std::string_view USAGE =
+	"Usage: twitch-limiter-backtest <history.ndjson> [--limits LIST] [--timeouts LIST] [--threads N]\n"
+	"                               [--cooldowns] [--adaptive PERCENT]\n"
+	"\n"
+	"Replays recorded EventSub notifications (one message per line) against every\n"
+	"combination of max_bet_limit and bet_timeout_duration and prints one CSV row per\n"
+	"combination to stdout. LIST is comma separated values and/or FROM:TO:STEP ranges.\n"
+	"--cooldowns replays with breach cooldowns enabled (off by default, as in the plugin).\n"
+	"--adaptive replays the adaptive limit, tightening to PERCENT of each limit during bursts.\n"
+	"Defaults: --limits 1000:20000:1000 --timeouts 10,30,60 --threads <cores>\n";
+//--------------------------------------------------------------
+// "5000", "1000,2000", "1000:20000:500" or any comma separated mix of them
+static bool parse_list(std::string_view text, std::vector<uint64_t> &values)
+{
+	values.clear();
+	while (!text.empty()) {
+		const size_t comma = text.find(',');
+		const std::string item(text.substr(0, comma));
+		text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1UL);
+
+		unsigned long long from = 0ULL, to = 0ULL, step = 0ULL;
+		int consumed = 0;
+		if (std::sscanf(item.c_str(), "%llu:%llu:%llu%n", &from, &to, &step, &consumed) == 3 and
+		    static_cast<size_t>(consumed) == item.size() and step > 0ULL and from <= to) {
+			for (unsigned long long value = from; value <= to; value += step) {
+				values.push_back(value);
+			}
+		} else if (std::sscanf(item.c_str(), "%llu%n", &from, &consumed) == 1 and
+			   static_cast<size_t>(consumed) == item.size()) {
+			values.push_back(from);
+		} else {
+			return false;
+		}
+	}
+	return !values.empty();
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	std::string path;
+	std::string_view limits = DEFAULT_LIMITS, timeouts = DEFAULT_TIMEOUTS;
+	size_t threads = 0UL, adaptive_percent = 0UL;
+	bool breach_cooldowns = false;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		const bool has_value = i + 1 < argc;
+		if (arg == "--limits" and has_value) {
+			limits = argv[++i];
+		} else if (arg == "--timeouts" and has_value) {
+			timeouts = argv[++i];
+		} else if (arg == "--threads" and has_value) {
+			threads = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--adaptive" and has_value) {
+			adaptive_percent = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--cooldowns") {
+			breach_cooldowns = true;
+		} else if (path.empty() and !arg.starts_with("--")) {
+			path = arg;
+		} else {
+			std::fputs(USAGE.data(), stderr);
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::vector<uint64_t> limit_values, timeout_values;
+	if (path.empty() or adaptive_percent > 100UL or !parse_list(limits, limit_values) or
+	    !parse_list(timeouts, timeout_values)) {
+		std::fputs(USAGE.data(), stderr);
+		return EXIT_FAILURE;
+	}
+
+	// The shared decoder logs every prediction lock and end, which only makes sense live
+	set_log_level(LogLevel::Warning);
+
+	auto start = std::chrono::steady_clock::now();
+	RedemptionHistory history;
+	if (!history.load(path)) {
+		return EXIT_FAILURE;
+	}
+	const double load_seconds = seconds_since(start);
+
+	std::vector<PolicyBacktest::Config> configs;
+	configs.reserve(limit_values.size() * timeout_values.size());
+	for (const uint64_t limit : limit_values) {
+		for (const uint64_t timeout : timeout_values) {
+			configs.push_back(PolicyBacktest::Config{limit, timeout, breach_cooldowns});
+		}
+	}
+
+	start = std::chrono::steady_clock::now();
+	const PolicyBacktest backtest(history, adaptive_percent);
+	const std::vector<PolicyBacktest::Result> results = backtest.run(configs, threads);
+	const double run_seconds = seconds_since(start);
+
+	std::printf("max_bet_limit,bet_timeout_duration,breaches,overlays,suppressed,overlay_seconds\n");
+	for (const PolicyBacktest::Result &result : results) {
+		std::printf("%llu,%llu,%llu,%llu,%llu,%.3f\n",
+			    static_cast<unsigned long long>(result.config.max_bet_limit),
+			    static_cast<unsigned long long>(result.config.bet_timeout_duration),
+			    static_cast<unsigned long long>(result.breaches),
+			    static_cast<unsigned long long>(result.overlays),
+			    static_cast<unsigned long long>(result.suppressed), result.overlay_seconds);
+	}
+
+	std::fprintf(stderr,
+		     "%zu bets (%zu users, %zu rewards, %zu lines skipped) loaded in %.2f s; "
+		     "%zu configs evaluated in %.3f s (%.0f M bet-configs/s)\n",
+		     history.size(), history.user_count(), history.reward_count(), history.skipped_lines(),
+		     load_seconds, configs.size(), run_seconds,
+		     static_cast<double>(history.size()) * static_cast<double>(configs.size()) / run_seconds / 1e6);
+	if (adaptive_percent > 0UL) {
+		std::fprintf(stderr, "adaptive limit tightened %llu times\n",
+			     static_cast<unsigned long long>(backtest.tightenings()));
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,181 @@
+#include "policy_backtest.hpp"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <thread>
+#include "adaptive_limit.hpp"
+#include "bet_policy.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr int64_t MILLISECONDS_PER_SECOND = 1000;
+//--------------------------------------------------------------
+// Returns true when `key` was already cooling down at `now`; otherwise starts its cooldown
+static bool start_cooldown(std::vector<int64_t> &cooldowns, uint32_t key, int64_t now, int64_t duration)
+{
+	if (key == RedemptionHistory::NO_KEY) {
+		return false;
+	}
+	if (cooldowns[key] > now) {
+		return true; // A running cooldown is not extended
+	}
+	cooldowns[key] = now + duration;
+	return false;
+}
+//--------------------------------------------------------------
+// **🔹 Constructor**
+PolicyBacktest::PolicyBacktest(const RedemptionHistory &history, size_t adaptive_percent)
+	: m_history(history),
+	  m_adaptive_percent(adaptive_percent),
+	  m_tightened(),
+	  m_tightenings(0UL)
+{
+	if (m_adaptive_percent > 0UL) {
+		replay_adaptive_limit();
+	}
+}
+
+uint64_t PolicyBacktest::tightenings(void) const
+{
+	return m_tightenings;
+}
+
+// **🔹 Adaptive Limit**
+// Feeds every bet at its recorded time, and runs `decay` where the live timing wheel would: every
+// DECAY_INTERVAL from the first bet that left the limit tightened, until it relaxes
+void PolicyBacktest::replay_adaptive_limit(void)
+{
+	AdaptiveLimit adaptive;
+	adaptive.configure(true, m_adaptive_percent);
+
+	const auto &amounts = m_history.amounts();
+	const auto &previous_amounts = m_history.previous_amounts();
+	m_tightened.resize(amounts.size());
+	bool decay_pending = false;
+	AdaptiveLimit::Clock::time_point next_decay;
+
+	for (size_t i = 0UL; i < amounts.size(); ++i) {
+		const AdaptiveLimit::Clock::time_point now(std::chrono::milliseconds(m_history.timestamps_ms()[i]));
+		while (decay_pending and next_decay <= now) {
+			decay_pending = adaptive.decay(1UL, next_decay);
+			next_decay += AdaptiveLimit::DECAY_INTERVAL;
+		}
+
+		// Only tightened() is kept: the limit it implies is worked out per config
+		adaptive.observe(amounts[i] > previous_amounts[i] ? amounts[i] - previous_amounts[i] : 0UL, 1UL, now);
+		m_tightened[i] = adaptive.tightened() ? 1U : 0U;
+		if (m_tightened[i] and !decay_pending) {
+			decay_pending = true;
+			next_decay = now + AdaptiveLimit::DECAY_INTERVAL;
+		}
+	}
+	m_tightenings = adaptive.status().tightenings;
+}
+
+// **🔹 Evaluation**
+PolicyBacktest::Result PolicyBacktest::evaluate(const Config &config) const
+{
+	Scratch scratch;
+	return evaluate(candidates(config.max_bet_limit), config, scratch);
+}
+
+std::vector<PolicyBacktest::Result> PolicyBacktest::run(const std::vector<Config> &configs, size_t threads) const
+{
+	std::vector<Result> results(configs.size());
+	if (configs.empty()) {
+		return results;
+	}
+
+	uint64_t minimum_limit = std::numeric_limits<uint64_t>::max();
+	for (const Config &config : configs) {
+		minimum_limit = std::min(minimum_limit, config.max_bet_limit);
+	}
+	const Candidates bets = candidates(minimum_limit);
+
+	if (threads == 0UL) {
+		threads = std::max<size_t>(std::thread::hardware_concurrency(), 1UL);
+	}
+	threads = std::min(threads, configs.size());
+
+	// Configs are handed out one at a time, so uneven costs (low limits breach more) balance out
+	std::atomic<size_t> next(0UL);
+	auto worker = [&]() {
+		Scratch scratch;
+		for (size_t index = next.fetch_add(1UL); index < configs.size(); index = next.fetch_add(1UL)) {
+			results[index] = evaluate(bets, configs[index], scratch);
+		}
+	};
+
+	std::vector<std::thread> pool;
+	pool.reserve(threads - 1UL);
+	for (size_t i = 1UL; i < threads; ++i) {
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (std::thread &thread : pool) {
+		thread.join();
+	}
+	return results;
+}
+
+PolicyBacktest::Candidates PolicyBacktest::candidates(uint64_t minimum_limit) const
+{
+	Candidates bets;
+	const auto &amounts = m_history.amounts();
+	const uint64_t tightened_minimum =
+		m_adaptive_percent > 0UL ? AdaptiveLimit::tightened_limit(minimum_limit, m_adaptive_percent) : 0UL;
+	for (size_t i = 0UL; i < amounts.size(); ++i) {
+		const bool tightened = !m_tightened.empty() and m_tightened[i];
+		if (amounts[i] <= (tightened ? tightened_minimum : minimum_limit)) {
+			continue;
+		}
+		bets.timestamps.push_back(m_history.timestamps_ms()[i]);
+		bets.amounts.push_back(amounts[i]);
+		bets.previous_amounts.push_back(m_history.previous_amounts()[i]);
+		bets.users.push_back(m_history.users()[i]);
+		bets.rewards.push_back(m_history.rewards()[i]);
+		bets.tightened.push_back(tightened ? 1U : 0U);
+	}
+	return bets;
+}
+
+PolicyBacktest::Result PolicyBacktest::evaluate(const Candidates &bets, const Config &config, Scratch &scratch) const
+{
+	const int64_t timeout = static_cast<int64_t>(config.bet_timeout_duration) * MILLISECONDS_PER_SECOND;
+	scratch.user_cooldowns.assign(m_history.user_count(), std::numeric_limits<int64_t>::min());
+	scratch.reward_cooldowns.assign(m_history.reward_count(), std::numeric_limits<int64_t>::min());
+
+	Result result{config, 0UL, 0UL, 0UL, 0.0};
+	int64_t overlay_end = std::numeric_limits<int64_t>::min();
+	int64_t overlay_milliseconds = 0;
+
+	const uint64_t tightened_limit = m_adaptive_percent > 0UL ? AdaptiveLimit::tightened_limit(
+									   config.max_bet_limit, m_adaptive_percent)
+								 : config.max_bet_limit;
+	for (size_t i = 0UL; i < bets.amounts.size(); ++i) {
+		const uint64_t limit = bets.tightened[i] ? tightened_limit : config.max_bet_limit;
+		if (!exceeds_limit(bets.amounts[i], bets.previous_amounts[i], limit)) {
+			continue;
+		}
+
+		++result.breaches;
+		const int64_t now = bets.timestamps[i];
+		if (config.breach_cooldowns) {
+			const bool user_cooling = start_cooldown(scratch.user_cooldowns, bets.users[i], now, timeout);
+			const bool reward_cooling =
+				start_cooldown(scratch.reward_cooldowns, bets.rewards[i], now, timeout);
+			if (user_cooling or reward_cooling) {
+				++result.suppressed;
+				continue;
+			}
+		}
+
+		// Visible time is the union of [shown, shown + timeout) intervals
+		++result.overlays;
+		overlay_milliseconds += now + timeout - std::max(now, overlay_end);
+		overlay_end = now + timeout;
+	}
+
+	result.overlay_seconds = static_cast<double>(overlay_milliseconds) / MILLISECONDS_PER_SECOND;
+	return result;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "redemption_history.hpp"
+
+// Replays a RedemptionHistory against candidate (max_bet_limit, bet_timeout_duration)
+// pairs with the same rules as EventSub::check_bet: every breach is counted, with breach
+// cooldowns enabled a breach by a user or on a reward that is still cooling down does not
+// show the overlay, and a shown overlay stays up for the timeout, a newer one replacing
+// the pending hide. With an adaptive percent the AdaptiveLimit controller is run once over
+// the recorded timestamps (its decisions do not depend on the base limit), and each config
+// applies its tightened limit to the bets that arrived while it was tightened.
+class PolicyBacktest {
+public:
+	struct Config {
+		uint64_t max_bet_limit;
+		uint64_t bet_timeout_duration; // seconds
+		bool breach_cooldowns;         // EventSub::set_breach_cooldowns
+	};
+
+	struct Result {
+		Config config;
+		uint64_t breaches;   // bets over the limit (would-be refunds)
+		uint64_t overlays;   // breaches that showed the overlay
+		uint64_t suppressed; // breaches swallowed by a running cooldown
+		double overlay_seconds;
+	};
+
+	// `adaptive_percent` 0 leaves the adaptive limit off, as in the plugin's default settings
+	explicit PolicyBacktest(const RedemptionHistory &history, size_t adaptive_percent = 0UL);
+
+	uint64_t tightenings(void) const;
+
+	Result evaluate(const Config &config) const;
+
+	// Evaluates every config, spreading them over `threads` workers (0: one per core)
+	std::vector<Result> run(const std::vector<Config> &configs, size_t threads = 0UL) const;
+
+private:
+	// Bets that at least one candidate limit can flag, copied once before any config runs
+	struct Candidates {
+		std::vector<int64_t> timestamps;
+		std::vector<uint64_t> amounts, previous_amounts;
+		std::vector<uint32_t> users, rewards;
+		std::vector<uint8_t> tightened;
+	};
+
+	struct Scratch {
+		std::vector<int64_t> user_cooldowns, reward_cooldowns; // cooldown end per id, in ms
+	};
+
+	void replay_adaptive_limit(void);
+	Candidates candidates(uint64_t minimum_limit) const;
+	Result evaluate(const Candidates &bets, const Config &config, Scratch &scratch) const;
+
+	const RedemptionHistory &m_history;
+	const size_t m_adaptive_percent;
+	std::vector<uint8_t> m_tightened; // per bet, empty while the adaptive limit is off
+	uint64_t m_tightenings;
+};
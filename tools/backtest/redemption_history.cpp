@@ -0,0 +1,271 @@
+#include "redemption_history.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include "eventsub_json.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr std::string_view EVENTSUB_TYPE_NOTIFICATION = "notification";
+constexpr size_t INITIAL_EVENT_CAPACITY = 1UL << 20;
+//--------------------------------------------------------------
+// **🔹 Timestamp Parsing**
+// RFC 3339 as used by EventSub ("2024-05-01T19:04:11.123456789Z", offsets allowed), to Unix milliseconds
+static int64_t days_from_civil(int64_t year, int64_t month, int64_t day)
+{
+	year -= month <= 2 ? 1 : 0;
+	const int64_t era = (year >= 0 ? year : year - 399) / 400;
+	const int64_t year_of_era = year - era * 400;
+	const int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+	return era * 146097 + day_of_era - 719468;
+}
+
+static bool parse_digits(std::string_view text, size_t offset, size_t count, int64_t &value)
+{
+	if (offset + count > text.size()) {
+		return false;
+	}
+	value = 0;
+	for (size_t i = offset; i < offset + count; ++i) {
+		if (text[i] < '0' or text[i] > '9') {
+			return false;
+		}
+		value = value * 10 + (text[i] - '0');
+	}
+	return true;
+}
+
+static bool parse_timestamp(std::string_view text, int64_t &milliseconds)
+{
+	int64_t year, month, day, hour, minute, second;
+	if (!parse_digits(text, 0, 4, year) or !parse_digits(text, 5, 2, month) or !parse_digits(text, 8, 2, day) or
+	    !parse_digits(text, 11, 2, hour) or !parse_digits(text, 14, 2, minute) or
+	    !parse_digits(text, 17, 2, second)) {
+		return false;
+	}
+
+	size_t position = 19UL;
+	int64_t fraction = 0, scale = 1000;
+	if (position < text.size() and text[position] == '.') {
+		for (++position; position < text.size() and text[position] >= '0' and text[position] <= '9'; ++position) {
+			if (scale > 1) {
+				scale /= 10;
+				fraction += (text[position] - '0') * scale;
+			}
+		}
+	}
+
+	int64_t offset_minutes = 0;
+	if (position < text.size() and (text[position] == '+' or text[position] == '-')) {
+		int64_t offset_hour, offset_minute;
+		if (!parse_digits(text, position + 1UL, 2, offset_hour) or
+		    !parse_digits(text, position + 4UL, 2, offset_minute)) {
+			return false;
+		}
+		offset_minutes = (offset_hour * 60 + offset_minute) * (text[position] == '-' ? -1 : 1);
+	}
+
+	const int64_t seconds = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second -
+				offset_minutes * 60;
+	milliseconds = seconds * 1000 + fraction;
+	return true;
+}
+//--------------------------------------------------------------
+// **🔹 Constructor**
+RedemptionHistory::RedemptionHistory(void)
+	: m_document(),
+	  m_decoder(),
+	  m_user_ids(),
+	  m_reward_ids(),
+	  m_skipped(0UL),
+	  m_deferred()
+{
+}
+
+// **🔹 Loading**
+bool RedemptionHistory::load(const std::string &path)
+{
+	std::ifstream input(path, std::ios::binary);
+	if (!input) {
+		std::fprintf(stderr, "Cannot open history file '%s'\n", path.c_str());
+		return false;
+	}
+
+	m_timestamps.reserve(INITIAL_EVENT_CAPACITY);
+	m_amounts.reserve(INITIAL_EVENT_CAPACITY);
+	m_previous_amounts.reserve(INITIAL_EVENT_CAPACITY);
+	m_users.reserve(INITIAL_EVENT_CAPACITY);
+	m_rewards.reserve(INITIAL_EVENT_CAPACITY);
+	m_lines.reserve(INITIAL_EVENT_CAPACITY);
+
+	std::string line;
+	for (uint64_t number = 1UL; std::getline(input, line); ++number) {
+		if (line.find_first_not_of(" \t\r") == std::string::npos) {
+			continue;
+		}
+		if (!parse_line(line, number, true)) {
+			++m_skipped;
+		}
+	}
+
+	decode_deferred();
+	sort_by_time();
+	return true;
+}
+
+bool RedemptionHistory::parse_line(std::string_view message, uint64_t line, bool defer_ordered)
+{
+	m_document.Parse(message.data(), message.size());
+	if (m_document.HasParseError() or !m_document.IsObject()) {
+		return false;
+	}
+
+	if (eventsub_message_type(m_document) != EVENTSUB_TYPE_NOTIFICATION) {
+		return true; // welcome, keepalive, ...: valid but not a bet
+	}
+
+	const rapidjson::Value &payload = eventsub_payload(m_document);
+	const rapidjson::Value *subscription = json_object(payload, "subscription");
+	const rapidjson::Value *event = json_object(payload, "event");
+	if (!subscription or !event) {
+		return false;
+	}
+
+	// The delivery timestamp orders everything; a redemption's own `redeemed_at` is the fallback
+	const rapidjson::Value *metadata = json_object(m_document, "metadata");
+	int64_t timestamp = 0;
+	if (!parse_timestamp(metadata ? json_string(*metadata, "message_timestamp") : std::string_view(), timestamp) and
+	    !parse_timestamp(json_string(*event, "redeemed_at"), timestamp)) {
+		return false;
+	}
+
+	const std::string_view subscription_type = json_string(*subscription, "type");
+	if (defer_ordered and BetDecoder::order_dependent(subscription_type)) {
+		m_deferred.push_back(Deferred{timestamp, line, std::string(message)});
+		return true;
+	}
+
+	return m_decoder.decode(subscription_type, *event, [this, timestamp, line](const BetDecoder::Bet &bet) {
+		append(timestamp, line, bet);
+	}) != BetDecoder::Result::Invalid;
+}
+
+// Prediction spends are running totals, so their (spend, previous spend) pairs are only right when
+// the events reach the decoder in time order; a file that interleaves sessions is sorted first.
+void RedemptionHistory::decode_deferred(void)
+{
+	std::stable_sort(m_deferred.begin(), m_deferred.end(),
+			 [](const Deferred &a, const Deferred &b) { return a.timestamp < b.timestamp; });
+	for (const Deferred &deferred : m_deferred) {
+		if (!parse_line(deferred.message, deferred.line, false)) {
+			++m_skipped;
+		}
+	}
+	m_deferred = std::vector<Deferred>();
+}
+
+void RedemptionHistory::append(int64_t timestamp, uint64_t line, const BetDecoder::Bet &bet)
+{
+	m_timestamps.push_back(timestamp);
+	m_amounts.push_back(bet.amount);
+	m_previous_amounts.push_back(bet.previous_amount);
+	m_users.push_back(intern(m_user_ids, bet.user_id)); // the live cooldowns are keyed by id too
+	m_rewards.push_back(intern(m_reward_ids, bet.reward));
+	m_lines.push_back(line);
+}
+
+// Recordings may interleave files or sessions; ties are broken by source line, so same-millisecond
+// bets keep their file order (and bets from one message their event order)
+void RedemptionHistory::sort_by_time(void)
+{
+	auto before = [this](size_t a, size_t b) {
+		return m_timestamps[a] != m_timestamps[b] ? m_timestamps[a] < m_timestamps[b] : m_lines[a] < m_lines[b];
+	};
+
+	bool sorted = true;
+	for (size_t i = 1UL; i < m_timestamps.size() and sorted; ++i) {
+		sorted = !before(i, i - 1UL);
+	}
+
+	if (!sorted) {
+		std::vector<uint32_t> order(m_timestamps.size());
+		std::iota(order.begin(), order.end(), 0U);
+		std::stable_sort(order.begin(), order.end(), before);
+
+		auto permute = [&order](auto &values) {
+			std::remove_reference_t<decltype(values)> sorted_values;
+			sorted_values.reserve(values.size());
+			for (const uint32_t index : order) {
+				sorted_values.push_back(values[index]);
+			}
+			values.swap(sorted_values);
+		};
+		permute(m_timestamps);
+		permute(m_amounts);
+		permute(m_previous_amounts);
+		permute(m_users);
+		permute(m_rewards);
+	}
+	m_lines = std::vector<uint64_t>(); // only needed for ordering
+}
+
+uint32_t RedemptionHistory::intern(InternTable &table, std::string_view key)
+{
+	if (key.empty()) {
+		return NO_KEY;
+	}
+
+	auto it = table.find(key);
+	if (it == table.end()) {
+		it = table.emplace(std::string(key), static_cast<uint32_t>(table.size())).first;
+	}
+	return it->second;
+}
+
+// **🔹 Accessors**
+size_t RedemptionHistory::size(void) const
+{
+	return m_timestamps.size();
+}
+
+size_t RedemptionHistory::user_count(void) const
+{
+	return m_user_ids.size();
+}
+
+size_t RedemptionHistory::reward_count(void) const
+{
+	return m_reward_ids.size();
+}
+
+size_t RedemptionHistory::skipped_lines(void) const
+{
+	return m_skipped;
+}
+
+const std::vector<int64_t> &RedemptionHistory::timestamps_ms(void) const
+{
+	return m_timestamps;
+}
+
+const std::vector<uint64_t> &RedemptionHistory::amounts(void) const
+{
+	return m_amounts;
+}
+
+const std::vector<uint64_t> &RedemptionHistory::previous_amounts(void) const
+{
+	return m_previous_amounts;
+}
+
+const std::vector<uint32_t> &RedemptionHistory::users(void) const
+{
+	return m_users;
+}
+
+const std::vector<uint32_t> &RedemptionHistory::rewards(void) const
+{
+	return m_rewards;
+}
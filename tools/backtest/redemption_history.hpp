@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <rapidjson/document.h>
+#include "bet_decoder.hpp"
+
+// Recorded EventSub traffic reduced to what the limit policy looks at. The history is
+// read from NDJSON (one EventSub message per line, wrapped or flat, exactly as the
+// websocket delivers it) and stored as parallel arrays sorted by time, with users and
+// rewards interned to dense ids so a backtest can keep its cooldown state in plain vectors.
+class RedemptionHistory {
+public:
+	static constexpr uint32_t NO_KEY = UINT32_MAX; // empty user / reward: never cools down
+
+	RedemptionHistory(void);
+
+	bool load(const std::string &path);
+
+	size_t size(void) const;
+	size_t user_count(void) const;
+	size_t reward_count(void) const;
+	size_t skipped_lines(void) const;
+
+	// Parallel arrays, index i is one bet in time order
+	const std::vector<int64_t> &timestamps_ms(void) const;
+	const std::vector<uint64_t> &amounts(void) const;
+	const std::vector<uint64_t> &previous_amounts(void) const;
+	const std::vector<uint32_t> &users(void) const;
+	const std::vector<uint32_t> &rewards(void) const;
+
+private:
+	struct TransparentHash {
+		using is_transparent = void;
+		size_t operator()(std::string_view key) const noexcept { return std::hash<std::string_view>{}(key); }
+	};
+	using InternTable = std::unordered_map<std::string, uint32_t, TransparentHash, std::equal_to<>>;
+
+	// A notification whose bets depend on earlier events, kept until the history can be replayed in time order
+	struct Deferred {
+		int64_t timestamp;
+		uint64_t line;
+		std::string message;
+	};
+
+	bool parse_line(std::string_view message, uint64_t line, bool defer_ordered);
+	void decode_deferred(void);
+	void append(int64_t timestamp, uint64_t line, const BetDecoder::Bet &bet);
+	void sort_by_time(void);
+
+	static uint32_t intern(InternTable &table, std::string_view key);
+
+	rapidjson::Document m_document;
+	BetDecoder m_decoder;
+	InternTable m_user_ids, m_reward_ids;
+	size_t m_skipped;
+	std::vector<Deferred> m_deferred;
+
+	std::vector<int64_t> m_timestamps;
+	std::vector<uint64_t> m_amounts, m_previous_amounts;
+	std::vector<uint32_t> m_users, m_rewards;
+	std::vector<uint64_t> m_lines; // source line of each bet, ties same-millisecond bets to file order
+};
@@ -0,0 +1,190 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include "eventsub.hpp"
+#include "logger.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr std::string_view LISTEN_ADDRESS = "127.0.0.1";
+constexpr unsigned long DEFAULT_PORT = 18443UL;
+constexpr unsigned long DEFAULT_KEEPALIVE = 4UL;
+constexpr unsigned long DEFAULT_ACTIVE = 3UL;
+constexpr unsigned long DEFAULT_ROUNDS = 3UL;
+constexpr auto DETECTION_TOLERANCE = std::chrono::milliseconds(1000);
+constexpr auto ROUND_TIMEOUT = std::chrono::seconds(120); // covers the core's reconnect backoff
+constexpr std::string_view USAGE =
+	"Usage: twitch-limiter-keepalive-mock [--keepalive SECONDS] [--active SECONDS] [--rounds N] [--port PORT]\n"
+	"                                     [--verbose]\n"
+	"\n"
+	"Serves an EventSub stand-in on 127.0.0.1 and points the limiter core at it. Each round the\n"
+	"mock sends session_welcome (with --keepalive as keepalive_timeout_seconds) and one\n"
+	"session_keepalive per second for --active seconds, then goes silent without closing the\n"
+	"connection: no frames, no pongs, like a half-open TCP peer. Prints how long the core took to\n"
+	"declare the session dead and fails if that exceeds the keepalive timeout by more than 1 s.\n";
+//--------------------------------------------------------------
+// Shared between the mock server thread and the EventSub status callback
+struct Round {
+	std::mutex mutex;
+	std::condition_variable changed;
+	bool connected = false;
+	std::chrono::steady_clock::time_point silent_since, detected_at;
+	size_t disconnects = 0UL;
+};
+
+static std::string eventsub_message(std::string_view type, std::string_view payload)
+{
+	return std::string(R"({"metadata":{"message_type":")") + std::string(type) + R"("},"payload":)" +
+	       std::string(payload) + "}";
+}
+
+// One connection per round; the socket is only dropped once the core has given up on it
+static bool serve_rounds(boost::asio::ip::tcp::acceptor &acceptor, Round &round, unsigned long rounds,
+			 unsigned long keepalive, unsigned long active)
+{
+	const std::string welcome = eventsub_message(
+		"session_welcome", R"({"session":{"id":"mock","status":"connected","keepalive_timeout_seconds":)" +
+					   std::to_string(keepalive) + "}}");
+	const std::string keepalive_message = eventsub_message("session_keepalive", "{}");
+
+	for (unsigned long i = 0UL; i < rounds; ++i) {
+		boost::system::error_code ec;
+		boost::beast::websocket::stream<boost::asio::ip::tcp::socket> websocket(acceptor.accept(ec));
+		if (!ec) {
+			websocket.accept(ec);
+		}
+		if (!ec) {
+			websocket.text(true);
+			websocket.write(boost::asio::buffer(welcome), ec);
+		}
+		for (unsigned long second = 0UL; !ec and second < active; ++second) {
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+			websocket.write(boost::asio::buffer(keepalive_message), ec);
+		}
+		if (ec) {
+			std::fprintf(stderr, "Mock server failed: %s\n", ec.message().c_str());
+			return false;
+		}
+
+		std::unique_lock<std::mutex> lock(round.mutex);
+		const size_t disconnects = round.disconnects;
+		round.silent_since = std::chrono::steady_clock::now();
+		round.changed.wait_for(lock, ROUND_TIMEOUT, [&]() { return round.disconnects != disconnects; });
+		lock.unlock();
+
+		boost::system::error_code ignored;
+		websocket.next_layer().close(ignored);
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long port = DEFAULT_PORT, keepalive = DEFAULT_KEEPALIVE, active = DEFAULT_ACTIVE,
+		      rounds = DEFAULT_ROUNDS;
+	bool verbose = false;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		const bool has_value = i + 1 < argc;
+		if (arg == "--keepalive" and has_value) {
+			keepalive = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--active" and has_value) {
+			active = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--rounds" and has_value) {
+			rounds = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--port" and has_value) {
+			port = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--verbose") {
+			verbose = true;
+		} else {
+			std::fputs(USAGE.data(), stderr);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (keepalive == 0UL or rounds == 0UL or port == 0UL or port > 65535UL) {
+		std::fputs(USAGE.data(), stderr);
+		return EXIT_FAILURE;
+	}
+	set_log_level(verbose ? LogLevel::Debug : LogLevel::Warning);
+
+	boost::asio::io_context io_context;
+	boost::system::error_code ec;
+	const boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::make_address(LISTEN_ADDRESS.data(), ec),
+						      static_cast<unsigned short>(port));
+	boost::asio::ip::tcp::acceptor acceptor(io_context);
+	acceptor.open(endpoint.protocol(), ec);
+	if (!ec) {
+		acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
+	}
+	if (!ec) {
+		acceptor.bind(endpoint, ec);
+	}
+	if (!ec) {
+		acceptor.listen(1, ec);
+	}
+	if (ec) {
+		std::fprintf(stderr, "Cannot listen on %s:%lu: %s\n", LISTEN_ADDRESS.data(), port,
+			     ec.message().c_str());
+		return EXIT_FAILURE;
+	}
+
+	Round round;
+	EventSub &eventsub = EventSub::instance();
+	eventsub.set_status_callback([&round](bool connected) {
+		std::lock_guard<std::mutex> lock(round.mutex);
+		if (round.connected and !connected) {
+			round.detected_at = std::chrono::steady_clock::now();
+			++round.disconnects;
+		}
+		round.connected = connected;
+		round.changed.notify_all();
+	});
+
+	// The core speaks plain WebSocket whatever the scheme, so the stand-in needs no certificate
+	eventsub.set_websocket_url("wss://" + std::string(LISTEN_ADDRESS) + ":" + std::to_string(port) + "/ws");
+	std::fprintf(stderr, "Mock EventSub on %s:%lu, keepalive %lu s, %lu round(s)\n", LISTEN_ADDRESS.data(), port,
+		     keepalive, rounds);
+
+	bool served = false;
+	std::thread server([&]() { served = serve_rounds(acceptor, round, rounds, keepalive, active); });
+	eventsub.initialize();
+
+	bool passed = true;
+	size_t checked = 0UL;
+	std::unique_lock<std::mutex> lock(round.mutex);
+	for (; checked < rounds; ++checked) {
+		if (!round.changed.wait_for(lock, ROUND_TIMEOUT, [&]() { return round.disconnects > checked; })) {
+			std::fprintf(stderr, "Round %zu: the session was never declared dead\n", checked + 1UL);
+			passed = false;
+			break;
+		}
+
+		const auto detection = round.detected_at - round.silent_since;
+		const long long detection_ms = std::chrono::duration_cast<std::chrono::milliseconds>(detection).count();
+		const bool in_time = detection <= std::chrono::seconds(keepalive) + DETECTION_TOLERANCE;
+		std::printf("round %zu: silent peer detected after %lld ms (keepalive %lu s)%s\n", checked + 1UL,
+			    detection_ms, keepalive, in_time ? "" : " - too late");
+		passed = passed and in_time;
+	}
+	lock.unlock();
+
+	if (passed) {
+		server.join();
+	} else {
+		server.detach(); // may still be waiting for a connection that will not come
+	}
+	std::fflush(stdout);
+	// The EventSub io thread is detached and never returns; skip static destruction underneath it
+	std::_Exit(passed and served ? EXIT_SUCCESS : EXIT_FAILURE);
+}
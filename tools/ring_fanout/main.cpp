@@ -0,0 +1,330 @@
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "event_ring.hpp"
+#include "logger.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr unsigned long DEFAULT_CONSUMERS = 4UL;
+constexpr unsigned long DEFAULT_EVENTS = 200000UL;
+constexpr uint64_t RING_SLOTS = 4096UL; // EventRing capacity; the lapped consumer keeps exactly this many
+constexpr unsigned int CHILD_ALARM_SECONDS = 60U;
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(1);
+constexpr auto HEARTBEAT_INTERVAL = std::chrono::milliseconds(200);
+constexpr auto TAKEOVER_TIMEOUT = std::chrono::seconds(10); // the core declares a publisher dead after 3 s
+constexpr std::string_view TAKEOVER_TITLE = "takeover";
+constexpr std::string_view USAGE =
+	"Usage: twitch-limiter-ring-fanout [--consumers N] [--events N] [--verbose]\n"
+	"\n"
+	"Checks the shared-memory EventRing across processes. The parent publishes a numbered sequence\n"
+	"to N forked consumers on one session; every event carries a pattern derived from its number,\n"
+	"so each consumer can verify ordering, that no event was torn by a concurrent overwrite, and\n"
+	"that received + dropped covers the whole sequence. One extra consumer only starts reading\n"
+	"after the publisher is done and must get exactly the last ring's worth, the rest counted as\n"
+	"dropped. Finally a publisher process is killed and a new one must take the session over once\n"
+	"the old heartbeat goes stale, with an attached consumer following it.\n";
+//--------------------------------------------------------------
+// The fields of event `index` are a function of the index, so a read mixing two writes is caught
+static EventRing::Event numbered_event(uint64_t index, std::string_view title)
+{
+	char user_id[24], user[32];
+	std::snprintf(user_id, sizeof(user_id), "%llu", static_cast<unsigned long long>(index));
+	std::snprintf(user, sizeof(user), "user-%016llx",
+		      static_cast<unsigned long long>(index * 0x9E3779B97F4A7C15ULL));
+	EventRing::Event event =
+		EventRing::make_event(EventRing::EventKind::Redemption, index, ~index, user_id, user, title);
+	event.reserved = static_cast<uint32_t>(index);
+	return event;
+}
+
+static bool intact(const EventRing::Event &event, std::string_view title)
+{
+	const EventRing::Event expected = numbered_event(event.amount, title);
+	return std::memcmp(&event, &expected, sizeof(EventRing::Event)) == 0;
+}
+
+static void send_byte(int fd)
+{
+	const char byte = 1;
+	(void)!write(fd, &byte, 1);
+}
+
+static bool wait_for_bytes(int fd, unsigned long count)
+{
+	char byte;
+	for (unsigned long i = 0UL; i < count; ++i) {
+		if (read(fd, &byte, 1) != 1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+[[noreturn]] static void finish(int status)
+{
+	std::fflush(stdout);
+	std::_Exit(status); // forked children must not run the parent's destructors (they own the segment)
+}
+
+// **🔹 Fan-out Consumers**
+// Reads until the whole sequence is accounted for; `late` consumers wait for the publisher to finish first
+static void run_consumer(const std::string &session, unsigned long id, uint64_t events, bool late, int ready_fd,
+			 int start_fd)
+{
+	alarm(CHILD_ALARM_SECONDS);
+	EventRing ring;
+	if (!ring.attach(session)) {
+		std::fprintf(stderr, "consumer %lu: cannot attach to '%s'\n", id, session.c_str());
+		finish(EXIT_FAILURE);
+	}
+	send_byte(ready_fd);
+	if (late and !wait_for_bytes(start_fd, 1UL)) {
+		finish(EXIT_FAILURE);
+	}
+
+	uint64_t received = 0UL, last = 0UL, out_of_order = 0UL, torn = 0UL;
+	bool first = true;
+	while (received + ring.dropped() < events) {
+		const size_t consumed = ring.consume([&](const EventRing::Event &event) {
+			if (!intact(event, "")) {
+				++torn;
+			}
+			if (!first and event.amount <= last) {
+				++out_of_order;
+			}
+			first = false;
+			last = event.amount;
+			++received;
+		});
+		if (consumed == 0UL) {
+			std::this_thread::sleep_for(POLL_INTERVAL);
+		}
+	}
+
+	const uint64_t dropped = ring.dropped();
+	bool passed = torn == 0UL and out_of_order == 0UL and received + dropped == events and last + 1UL == events;
+	if (late) {
+		// Nothing was written while it read, so it must see exactly the newest ring and drop the rest
+		const uint64_t kept = events < RING_SLOTS ? events : RING_SLOTS;
+		passed = passed and received == kept and dropped == events - kept;
+	}
+	std::printf("consumer %lu%s: received %llu, dropped %llu, torn %llu, out of order %llu%s\n", id,
+		    late ? " (lapped)" : "", static_cast<unsigned long long>(received),
+		    static_cast<unsigned long long>(dropped), static_cast<unsigned long long>(torn),
+		    static_cast<unsigned long long>(out_of_order), passed ? "" : " - FAILED");
+	finish(passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static bool reap(const std::vector<pid_t> &children)
+{
+	bool passed = true;
+	for (const pid_t child : children) {
+		int status = 0;
+		if (waitpid(child, &status, 0) != child or !WIFEXITED(status) or WEXITSTATUS(status) != EXIT_SUCCESS) {
+			passed = false;
+		}
+	}
+	return passed;
+}
+
+static bool check_fanout(const std::string &session, unsigned long consumers, uint64_t events)
+{
+	EventRing ring;
+	if (!ring.create(session)) {
+		std::fprintf(stderr, "Cannot create ring '%s'\n", session.c_str());
+		return false;
+	}
+
+	int ready[2], start[2];
+	if (pipe(ready) != 0 or pipe(start) != 0) {
+		std::perror("pipe");
+		return false;
+	}
+
+	std::fflush(stdout); // children inherit unflushed output
+	std::vector<pid_t> children;
+	for (unsigned long id = 0UL; id <= consumers; ++id) {
+		const pid_t child = fork();
+		if (child == 0) {
+			run_consumer(session, id, events, id == consumers, ready[1], start[0]);
+		} else if (child < 0) {
+			std::perror("fork");
+			return false;
+		}
+		children.push_back(child);
+	}
+
+	// Every consumer attaches at the current head, so publish only once all of them are in
+	if (!wait_for_bytes(ready[0], consumers + 1UL)) {
+		return false;
+	}
+	const auto started = std::chrono::steady_clock::now();
+	for (uint64_t index = 0UL; index < events; ++index) {
+		ring.publish(numbered_event(index, ""));
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+	std::printf("published %llu events to %lu consumers in %.3f s\n", static_cast<unsigned long long>(events),
+		    consumers + 1UL, seconds);
+	send_byte(start[1]);
+
+	const bool passed = reap(children);
+	for (const int fd : {ready[0], ready[1], start[0], start[1]}) {
+		close(fd);
+	}
+	return passed;
+}
+
+// **🔹 Publisher Takeover**
+static void run_doomed_publisher(const std::string &session, int ready_fd)
+{
+	alarm(CHILD_ALARM_SECONDS);
+	EventRing ring;
+	if (!ring.create(session)) {
+		finish(EXIT_FAILURE);
+	}
+	ring.publish(numbered_event(0UL, ""));
+	send_byte(ready_fd);
+	for (;;) { // until SIGKILL; the segment stays behind with a heartbeat that stops moving
+		ring.heartbeat();
+		std::this_thread::sleep_for(HEARTBEAT_INTERVAL);
+	}
+}
+
+// Stays attached across the publisher's death, re-attaches like EventSub's consumer mode does, and
+// passes once an event from the new publisher arrives intact
+static void run_following_consumer(const std::string &session, int ready_fd)
+{
+	alarm(CHILD_ALARM_SECONDS);
+	EventRing ring;
+	if (!ring.attach(session)) {
+		finish(EXIT_FAILURE);
+	}
+	send_byte(ready_fd);
+
+	bool followed = false, reattached = false;
+	while (!followed) {
+		if (!ring.publisher_alive()) {
+			reattached = ring.attach(session) and ring.publisher_alive();
+		}
+		ring.consume([&](const EventRing::Event &event) {
+			followed = followed or (reattached and intact(event, TAKEOVER_TITLE));
+		});
+		std::this_thread::sleep_for(POLL_INTERVAL);
+	}
+	std::printf("consumer followed the new publisher\n");
+	finish(EXIT_SUCCESS);
+}
+
+static bool check_takeover(const std::string &session)
+{
+	int ready[2];
+	if (pipe(ready) != 0) {
+		std::perror("pipe");
+		return false;
+	}
+
+	std::fflush(stdout);
+	const pid_t publisher = fork();
+	if (publisher == 0) {
+		run_doomed_publisher(session, ready[1]);
+	}
+	if (publisher < 0 or !wait_for_bytes(ready[0], 1UL)) {
+		return false;
+	}
+	const pid_t follower = fork();
+	if (follower == 0) {
+		run_following_consumer(session, ready[1]);
+	}
+	if (follower < 0 or !wait_for_bytes(ready[0], 1UL)) {
+		return false;
+	}
+	close(ready[0]);
+	close(ready[1]);
+
+	EventRing ring;
+	bool passed = true;
+	if (ring.create(session)) {
+		std::printf("takeover: a second publisher replaced a live one - FAILED\n");
+		passed = false;
+	}
+
+	kill(publisher, SIGKILL);
+	waitpid(publisher, nullptr, 0);
+	const auto killed = std::chrono::steady_clock::now();
+
+	bool created = false;
+	while (!created and std::chrono::steady_clock::now() - killed < TAKEOVER_TIMEOUT) {
+		created = ring.create(session);
+		if (!created) {
+			std::this_thread::sleep_for(HEARTBEAT_INTERVAL);
+		}
+	}
+	const auto took = std::chrono::steady_clock::now() - killed;
+	const long long waited = std::chrono::duration_cast<std::chrono::milliseconds>(took).count();
+	std::printf("takeover: new publisher after %lld ms%s\n", waited, created ? "" : " - FAILED");
+	passed = passed and created;
+
+	// Keep publishing until the follower has seen one of ours; it may re-attach at any point
+	int status = 0;
+	pid_t done = 0;
+	const auto deadline = killed + 2 * TAKEOVER_TIMEOUT;
+	for (uint64_t index = 1UL; created and done == 0 and std::chrono::steady_clock::now() < deadline; ++index) {
+		ring.heartbeat();
+		ring.publish(numbered_event(index, TAKEOVER_TITLE));
+		std::this_thread::sleep_for(HEARTBEAT_INTERVAL);
+		done = waitpid(follower, &status, WNOHANG);
+	}
+	if (done == 0) {
+		kill(follower, SIGKILL);
+		waitpid(follower, &status, 0);
+	}
+	const bool followed = WIFEXITED(status) and WEXITSTATUS(status) == EXIT_SUCCESS;
+	if (!followed) {
+		std::printf("takeover: the attached consumer never followed the new publisher - FAILED\n");
+	}
+	return passed and followed;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long consumers = DEFAULT_CONSUMERS, events = DEFAULT_EVENTS;
+	bool verbose = false;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		const bool has_value = i + 1 < argc;
+		if (arg == "--consumers" and has_value) {
+			consumers = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--events" and has_value) {
+			events = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--verbose") {
+			verbose = true;
+		} else {
+			std::fputs(USAGE.data(), stderr);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (consumers == 0UL or events == 0UL) {
+		std::fputs(USAGE.data(), stderr);
+		return EXIT_FAILURE;
+	}
+	set_log_level(verbose ? LogLevel::Debug : LogLevel::Error);
+
+	// Per-run session names, so parallel or aborted runs never share a segment
+	const std::string session = "ring-fanout-test-" + std::to_string(getpid());
+	const bool fanout = check_fanout(session, consumers, events);
+	const bool takeover = check_takeover(session + "-takeover");
+
+	std::printf("%s\n", fanout and takeover ? "PASSED" : "FAILED");
+	return fanout and takeover ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,151 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "overlay_template.hpp"
+#if __has_include(<format>)
+#include <format>
+#endif
+#if defined(__cpp_lib_format)
+#include <iterator>
+#endif
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr unsigned long DEFAULT_ITERATIONS = 2000000UL;
+constexpr size_t USER_COUNT = 64UL;
+constexpr std::string_view BENCH_TEMPLATE = "{user} bet {amount} on {reward}, the limit is {limit} (breach #{count})";
+constexpr std::string_view USAGE =
+	"Usage: twitch-limiter-template-bench [--iterations N]\n"
+	"\n"
+	"Renders one overlay message per iteration, with a different user, amount and count each\n"
+	"time, through std::string concatenation, snprintf, OverlayTemplate::render and, when the\n"
+	"standard library has <format>, std::format and std::format_to. Prints ns per message and\n"
+	"checks that every variant produced the same text.\n";
+//--------------------------------------------------------------
+struct Input {
+	std::string user;
+	uint64_t amount, limit, count;
+};
+
+static std::vector<Input> make_inputs(size_t count)
+{
+	std::vector<Input> inputs;
+	inputs.reserve(count);
+	for (size_t i = 0UL; i < count; ++i) {
+		inputs.push_back(Input{"viewer_" + std::to_string(i * 7919UL), 1000UL + i * 137UL, 5000UL, i + 1UL});
+	}
+	return inputs;
+}
+
+// Runs `render` once per iteration and returns ns per message; `length` keeps the work observable
+template<typename Render>
+static double measure(const std::vector<Input> &inputs, size_t iterations, size_t &length, Render &&render)
+{
+	length = 0UL;
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0UL; i < iterations; ++i) {
+		Input input = inputs[i % inputs.size()];
+		input.count += i;
+		length += render(input).size();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return seconds * 1e9 / static_cast<double>(iterations);
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long iterations = DEFAULT_ITERATIONS;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (arg == "--iterations" and i + 1 < argc) {
+			iterations = std::strtoul(argv[++i], nullptr, 10);
+		} else {
+			std::fputs(USAGE.data(), stderr);
+			return EXIT_FAILURE;
+		}
+	}
+	if (iterations == 0UL) {
+		std::fputs(USAGE.data(), stderr);
+		return EXIT_FAILURE;
+	}
+
+	const std::vector<Input> inputs = make_inputs(USER_COUNT);
+	const std::string reward = "Bet";
+
+	// Each variant keeps its last message, so the check below can compare what they produced
+	std::string concat_text;
+	auto concat = [&](const Input &input) -> std::string_view {
+		concat_text = input.user + " bet " + std::to_string(input.amount) + " on " + reward +
+			      ", the limit is " + std::to_string(input.limit) + " (breach #" +
+			      std::to_string(input.count) + ")";
+		return concat_text;
+	};
+
+	char snprintf_buffer[256];
+	auto snprintf_render = [&](const Input &input) -> std::string_view {
+		const int written =
+			std::snprintf(snprintf_buffer, sizeof(snprintf_buffer),
+				      "%s bet %llu on %s, the limit is %llu (breach #%llu)", input.user.c_str(),
+				      static_cast<unsigned long long>(input.amount), reward.c_str(),
+				      static_cast<unsigned long long>(input.limit),
+				      static_cast<unsigned long long>(input.count));
+		return std::string_view(snprintf_buffer, written > 0 ? static_cast<size_t>(written) : 0UL);
+	};
+
+	OverlayTemplate overlay_template;
+	overlay_template.compile(BENCH_TEMPLATE);
+	std::string_view template_text;
+	auto template_render = [&](const Input &input) -> std::string_view {
+		template_text = overlay_template.render({input.user, input.amount, input.limit, reward, input.count});
+		return template_text;
+	};
+
+	size_t length = 0UL;
+	struct Row {
+		const char *name;
+		double nanoseconds;
+		std::string last;
+	};
+	std::vector<Row> rows;
+	rows.push_back({"concat", measure(inputs, iterations, length, concat), std::string(concat_text)});
+	rows.push_back({"snprintf", measure(inputs, iterations, length, snprintf_render),
+			std::string(snprintf_buffer)});
+	rows.push_back({"OverlayTemplate::render", measure(inputs, iterations, length, template_render),
+			std::string(template_text)});
+
+#if defined(__cpp_lib_format)
+	std::string format_text;
+	auto format_render = [&](const Input &input) -> std::string_view {
+		format_text = std::format("{} bet {} on {}, the limit is {} (breach #{})", input.user, input.amount,
+					  reward, input.limit, input.count);
+		return format_text;
+	};
+	std::string format_to_text;
+	auto format_to_render = [&](const Input &input) -> std::string_view {
+		format_to_text.clear(); // reuses the capacity, like render()
+		std::format_to(std::back_inserter(format_to_text), "{} bet {} on {}, the limit is {} (breach #{})",
+			       input.user, input.amount, reward, input.limit, input.count);
+		return format_to_text;
+	};
+	rows.push_back({"std::format", measure(inputs, iterations, length, format_render), format_text});
+	rows.push_back({"std::format_to", measure(inputs, iterations, length, format_to_render), format_to_text});
+#else
+	std::printf("std::format: not available in this standard library, skipped\n");
+#endif
+
+	bool same = true;
+	for (const Row &row : rows) {
+		std::printf("%-24s %8.1f ns/message\n", row.name, row.nanoseconds);
+		same = same and row.last == rows.front().last;
+	}
+	std::printf("last message: %s (%zu bytes per run)\n", rows.front().last.c_str(), length);
+	if (!same) {
+		std::fprintf(stderr, "The variants rendered different text\n");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
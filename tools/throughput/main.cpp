@@ -0,0 +1,257 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include "adaptive_limit.hpp"
+#include "bet_sink.hpp"
+#include "eventsub.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr size_t DEFAULT_LIMIT = 5000UL;
+constexpr size_t POLL_INTERVAL = 4096UL;               // messages between runs of the cooldown timers
+constexpr size_t SOCKET_READ_SIZE = 256UL * 1024UL;
+constexpr std::string_view LISTEN_ADDRESS = "127.0.0.1";
+constexpr std::string_view USAGE =
+	"Usage: twitch-limiter-throughput (<messages.ndjson> | --listen PORT) [--repeat N] [--limit N]\n"
+	"                                 [--adaptive PERCENT] [--cooldowns] [--metrics] [--verbose]\n"
+	"\n"
+	"Pushes EventSub messages (one JSON message per line) through the limiter core as fast as\n"
+	"it can take them and reports messages per second on stderr. A file is read into memory\n"
+	"first and replayed --repeat times; --listen accepts one connection on 127.0.0.1 and\n"
+	"processes lines until the peer closes it. --cooldowns enables breach cooldowns (off by\n"
+	"default, as in the plugin). --adaptive also re-runs the adaptive controller alone over the\n"
+	"bets seen and reports its cost per bet. --metrics prints the Prometheus scrape to stdout.\n";
+//--------------------------------------------------------------
+// Tallies decisions without doing any work of its own, so the numbers are the core's
+class CountingSink : public BetSink {
+public:
+	void publish(const Event &event) override
+	{
+		if (keep_costs) {
+			costs.push_back(event.amount > event.previous_amount ? event.amount - event.previous_amount
+									     : 0UL);
+		}
+		if (event.kind == EventKind::Redemption) {
+			++redemptions;
+		} else if (event.suppressed) {
+			++suppressed;
+		} else {
+			++breaches;
+		}
+	}
+
+	size_t redemptions = 0UL, breaches = 0UL, suppressed = 0UL;
+	bool keep_costs = false;
+	std::vector<uint64_t> costs; // newly spent amount per bet, what check_bet feeds the controller
+};
+
+struct Totals {
+	size_t messages = 0UL, bytes = 0UL;
+};
+
+static void process_lines(std::string_view text, Totals &totals)
+{
+	while (!text.empty()) {
+		const size_t newline = text.find('\n');
+		const std::string_view line = text.substr(0, newline);
+		text = newline == std::string_view::npos ? std::string_view() : text.substr(newline + 1UL);
+		if (line.empty() or line == "\r") {
+			continue;
+		}
+
+		EventSub::instance().process_message(line);
+		totals.bytes += line.size();
+		if (++totals.messages % POLL_INTERVAL == 0UL) {
+			EventSub::instance().poll();
+		}
+	}
+}
+
+// Per-bet cost of AdaptiveLimit::observe as check_bet calls it, clock read included, against the
+// same loop with the controller disabled (observe returns immediately)
+static double observe_nanoseconds(const std::vector<uint64_t> &costs, bool enabled, size_t percent, size_t limit)
+{
+	AdaptiveLimit adaptive;
+	adaptive.configure(enabled, percent);
+	const auto start = std::chrono::steady_clock::now();
+	for (const uint64_t cost : costs) {
+		adaptive.observe(cost, limit, std::chrono::steady_clock::now()); // publishes atomics, never elided
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return costs.empty() ? 0.0 : seconds * 1e9 / static_cast<double>(costs.size());
+}
+
+static bool replay_file(const std::string &path, size_t repeat, Totals &totals, double &seconds)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		std::fprintf(stderr, "Cannot open %s\n", path.c_str());
+		return false;
+	}
+	const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0UL; i < repeat; ++i) {
+		process_lines(text, totals);
+	}
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return true;
+}
+
+// Lines may straddle reads; the unfinished tail is carried over to the next one
+static bool replay_socket(unsigned short port, Totals &totals, double &seconds)
+{
+	boost::asio::io_context io_context;
+	boost::system::error_code ec;
+	boost::asio::ip::tcp::acceptor acceptor(io_context);
+	const boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::make_address(LISTEN_ADDRESS.data(), ec), port);
+	acceptor.open(endpoint.protocol(), ec);
+	if (!ec) {
+		acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
+	}
+	if (!ec) {
+		acceptor.bind(endpoint, ec);
+	}
+	if (!ec) {
+		acceptor.listen(1, ec);
+	}
+	if (ec) {
+		std::fprintf(stderr, "Cannot listen on %s:%u: %s\n", LISTEN_ADDRESS.data(), static_cast<unsigned>(port),
+			     ec.message().c_str());
+		return false;
+	}
+
+	std::fprintf(stderr, "Waiting for a connection on %s:%u\n", LISTEN_ADDRESS.data(), static_cast<unsigned>(port));
+	boost::asio::ip::tcp::socket socket = acceptor.accept(ec);
+	if (ec) {
+		std::fprintf(stderr, "Accept failed: %s\n", ec.message().c_str());
+		return false;
+	}
+
+	std::string pending;
+	std::vector<char> chunk(SOCKET_READ_SIZE);
+	std::chrono::steady_clock::time_point start;
+	bool started = false;
+	for (;;) {
+		const size_t received = socket.read_some(boost::asio::buffer(chunk), ec);
+		if (!started and received > 0UL) {
+			start = std::chrono::steady_clock::now(); // time the core, not the wait for the sender
+			started = true;
+		}
+		pending.append(chunk.data(), received);
+
+		const size_t last_newline = pending.rfind('\n');
+		if (ec) {
+			process_lines(pending, totals); // the peer closed; whatever is left is the last line
+			break;
+		}
+		if (last_newline != std::string::npos) {
+			process_lines(std::string_view(pending).substr(0, last_newline + 1UL), totals);
+			pending.erase(0, last_newline + 1UL);
+		}
+	}
+
+	if (ec != boost::asio::error::eof) {
+		std::fprintf(stderr, "Read failed: %s\n", ec.message().c_str());
+	}
+	seconds = started ? std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() : 0.0;
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	std::string path;
+	unsigned long port = 0UL, repeat = 1UL, limit = DEFAULT_LIMIT, adaptive_percent = 0UL;
+	bool breach_cooldowns = false, print_metrics = false, verbose = false;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		const bool has_value = i + 1 < argc;
+		if (arg == "--listen" and has_value) {
+			port = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--repeat" and has_value) {
+			repeat = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--limit" and has_value) {
+			limit = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--adaptive" and has_value) {
+			adaptive_percent = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--cooldowns") {
+			breach_cooldowns = true;
+		} else if (arg == "--metrics") {
+			print_metrics = true;
+		} else if (arg == "--verbose") {
+			verbose = true;
+		} else if (path.empty() and !arg.starts_with("--")) {
+			path = arg;
+		} else {
+			std::fputs(USAGE.data(), stderr);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (path.empty() == (port == 0UL) or port > 65535UL or repeat == 0UL) {
+		std::fputs(USAGE.data(), stderr);
+		return EXIT_FAILURE;
+	}
+
+	// Per-message errors (invalid lines) would otherwise dominate the profile
+	set_log_level(verbose ? LogLevel::Debug : LogLevel::Warning);
+
+	CountingSink sink;
+	sink.keep_costs = adaptive_percent > 0UL;
+	size_t overlays = 0UL;
+	EventSub &eventsub = EventSub::instance();
+	eventsub.set_max_bet_limit(true, limit);
+	eventsub.set_adaptive_limit(adaptive_percent > 0UL, adaptive_percent);
+	eventsub.set_breach_cooldowns(breach_cooldowns);
+	eventsub.set_overlay_callback([&overlays](std::string_view, size_t) { ++overlays; });
+	eventsub.add_bet_sink(&sink);
+	eventsub.poll(); // applies the settings posted above
+
+	Totals totals;
+	double seconds = 0.0;
+	if (!(port > 0UL ? replay_socket(static_cast<unsigned short>(port), totals, seconds)
+			 : replay_file(path, repeat, totals, seconds))) {
+		return EXIT_FAILURE;
+	}
+	eventsub.poll();
+
+	const double rate = seconds > 0.0 ? static_cast<double>(totals.messages) / seconds : 0.0;
+	std::fprintf(stderr,
+		     "%zu messages (%.1f MB): %zu redemptions, %zu breaches, %zu suppressed, %zu overlays\n"
+		     "%.3f s, %.0f messages/s, %.1f MB/s, %.0f ns/message\n",
+		     totals.messages, static_cast<double>(totals.bytes) / 1e6, sink.redemptions, sink.breaches,
+		     sink.suppressed, overlays, seconds, rate,
+		     seconds > 0.0 ? static_cast<double>(totals.bytes) / seconds / 1e6 : 0.0,
+		     rate > 0.0 ? 1e9 / rate : 0.0);
+
+	if (adaptive_percent > 0UL) {
+		const double enabled_ns = observe_nanoseconds(sink.costs, true, adaptive_percent, limit);
+		const double disabled_ns = observe_nanoseconds(sink.costs, false, adaptive_percent, limit);
+		const AdaptiveLimit::Status status = eventsub.get_adaptive_limit_status();
+		std::fprintf(stderr,
+			     "adaptive limit: %.1f ns per bet over %zu bets (%.1f ns disabled), %.1f%% of the "
+			     "per-message time; %llu tightenings during the replay\n",
+			     enabled_ns, sink.costs.size(), disabled_ns,
+			     rate > 0.0 ? 100.0 * (enabled_ns - disabled_ns) * static_cast<double>(sink.costs.size()) /
+						  static_cast<double>(totals.messages) / (1e9 / rate)
+					: 0.0,
+			     static_cast<unsigned long long>(status.tightenings));
+	}
+
+	if (print_metrics) {
+		std::fputs(Metrics::instance().scrape().c_str(), stdout);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <string_view>
+#include <vector>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include "timing_wheel.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr unsigned long DEFAULT_TIMEOUTS = 1000000UL;
+constexpr unsigned long DEFAULT_FIRE = 200000UL;
+constexpr unsigned long DEFAULT_SPREAD_MS = 500UL;
+constexpr unsigned long MAX_COOLDOWN_SECONDS = 300UL; // the bet timeout slider's maximum
+constexpr std::string_view USAGE =
+	"Usage: twitch-limiter-timer-bench [--timeouts N] [--fire N] [--spread MS]\n"
+	"\n"
+	"Compares the TimingWheel with one boost::asio::steady_timer per timeout, the way the\n"
+	"limiter would track per-user and per-reward cooldowns without it. --timeouts cooldowns\n"
+	"of 1 to 300 s are scheduled and then all cancelled (a cancelled steady_timer still runs its\n"
+	"handler, so draining those is part of its cost); then --fire timeouts due within --spread\n"
+	"milliseconds are run to completion and the CPU time spent is reported.\n";
+//--------------------------------------------------------------
+struct Timing {
+	double wall_seconds, cpu_seconds;
+};
+
+template<typename Work> static Timing measure(Work &&work)
+{
+	const auto wall_start = std::chrono::steady_clock::now();
+	const std::clock_t cpu_start = std::clock();
+	work();
+	return {std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count(),
+		static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC};
+}
+
+static std::vector<std::chrono::milliseconds> random_delays(size_t count, unsigned long min_ms, unsigned long max_ms)
+{
+	std::mt19937_64 random(42U);
+	std::uniform_int_distribution<unsigned long> distribution(min_ms, max_ms);
+	std::vector<std::chrono::milliseconds> delays;
+	delays.reserve(count);
+	for (size_t i = 0UL; i < count; ++i) {
+		delays.emplace_back(distribution(random));
+	}
+	return delays;
+}
+
+static void report(const char *phase, size_t count, const Timing &wheel, const Timing &timers)
+{
+	const double n = static_cast<double>(count);
+	std::printf("%-9s %9zu  wheel %8.1f ns/op (cpu %8.1f)  steady_timer %8.1f ns/op (cpu %8.1f)  %5.1fx\n", phase,
+		    count, wheel.wall_seconds * 1e9 / n, wheel.cpu_seconds * 1e9 / n, timers.wall_seconds * 1e9 / n,
+		    timers.cpu_seconds * 1e9 / n, timers.cpu_seconds / wheel.cpu_seconds);
+}
+
+// **🔹 Schedule & Cancel**
+// Long cooldowns that mostly never fire: the common case, since the limiter cancels or outlives most of them
+static void bench_schedule_cancel(size_t count)
+{
+	const std::vector<std::chrono::milliseconds> delays =
+		random_delays(count, 1000UL, MAX_COOLDOWN_SECONDS * 1000UL);
+	size_t fired = 0UL;
+
+	boost::asio::io_context wheel_context;
+	TimingWheel wheel(wheel_context);
+	std::vector<TimingWheel::Handle> handles(count);
+	const Timing wheel_schedule = measure([&]() {
+		for (size_t i = 0UL; i < count; ++i) {
+			handles[i] = wheel.schedule(delays[i], [&fired]() { ++fired; });
+		}
+	});
+	const Timing wheel_cancel = measure([&]() {
+		for (TimingWheel::Handle &handle : handles) {
+			wheel.cancel(handle);
+		}
+		wheel_context.poll();
+	});
+
+	boost::asio::io_context timer_context;
+	std::vector<boost::asio::steady_timer> timers;
+	timers.reserve(count);
+	const Timing timer_schedule = measure([&]() {
+		for (size_t i = 0UL; i < count; ++i) {
+			timers.emplace_back(timer_context, delays[i]);
+			timers.back().async_wait([&fired](const boost::system::error_code &ec) {
+				if (!ec) {
+					++fired;
+				}
+			});
+		}
+	});
+	const Timing timer_cancel = measure([&]() {
+		for (boost::asio::steady_timer &timer : timers) {
+			timer.cancel();
+		}
+		timer_context.run(); // the aborted handlers
+	});
+
+	report("schedule", count, wheel_schedule, timer_schedule);
+	report("cancel", count, wheel_cancel, timer_cancel);
+	if (fired != 0UL) {
+		std::printf("warning: %zu cancelled timeouts fired\n", fired);
+	}
+}
+
+// **🔹 Expiry**
+static void bench_fire(size_t count, unsigned long spread_ms)
+{
+	const std::vector<std::chrono::milliseconds> delays = random_delays(count, 0UL, spread_ms);
+	size_t wheel_fired = 0UL, timer_fired = 0UL;
+
+	boost::asio::io_context wheel_context;
+	TimingWheel wheel(wheel_context);
+	const Timing wheel_run = measure([&]() {
+		for (size_t i = 0UL; i < count; ++i) {
+			wheel.schedule(delays[i], [&wheel_fired]() { ++wheel_fired; });
+		}
+		wheel_context.run();
+	});
+
+	boost::asio::io_context timer_context;
+	std::vector<boost::asio::steady_timer> timers;
+	timers.reserve(count);
+	const Timing timer_run = measure([&]() {
+		for (size_t i = 0UL; i < count; ++i) {
+			timers.emplace_back(timer_context, delays[i]);
+			timers.back().async_wait([&timer_fired](const boost::system::error_code &) { ++timer_fired; });
+		}
+		timer_context.run();
+	});
+
+	// Both sides sleep through the same spread, so only the CPU column is a fair comparison
+	report("fire", count, wheel_run, timer_run);
+	if (wheel_fired != count or timer_fired != count) {
+		std::printf("warning: fired %zu (wheel) and %zu (steady_timer) of %zu\n", wheel_fired, timer_fired,
+			    count);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long timeouts = DEFAULT_TIMEOUTS, fire = DEFAULT_FIRE, spread = DEFAULT_SPREAD_MS;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		const bool has_value = i + 1 < argc;
+		if (arg == "--timeouts" and has_value) {
+			timeouts = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--fire" and has_value) {
+			fire = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--spread" and has_value) {
+			spread = std::strtoul(argv[++i], nullptr, 10);
+		} else {
+			std::fputs(USAGE.data(), stderr);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (timeouts == 0UL or fire == 0UL) {
+		std::fputs(USAGE.data(), stderr);
+		return EXIT_FAILURE;
+	}
+
+	bench_schedule_cancel(timeouts);
+	bench_fire(fire, spread);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include "logger.hpp"
+#include "webhook_sink.hpp"
+//--------------------------------------------------------------
+// Definition
+//--------------------------------------------------------------
+constexpr std::string_view LISTEN_ADDRESS = "127.0.0.1";
+constexpr unsigned long DEFAULT_PORT = 18480UL;
+constexpr size_t BURST_EVENTS = 1200UL, BURST_CHUNK_EVENTS = 100UL;
+constexpr auto BURST_CHUNK_GAP = std::chrono::milliseconds(2);
+constexpr size_t TRICKLE_EVENTS = 3UL;
+constexpr size_t OUTAGE_EVENTS = 100UL, LATE_EVENTS = 50UL, RESTART_EVENTS = 40UL;
+constexpr unsigned FAILED_REQUESTS = 3U;
+constexpr auto FLUSH_WITHIN = std::chrono::milliseconds(1500); // the sink flushes every second
+constexpr auto BACKOFF_TOLERANCE = std::chrono::milliseconds(500);
+constexpr auto PHASE_TIMEOUT = std::chrono::seconds(30);
+constexpr auto SETTLE_POLL = std::chrono::milliseconds(10);
+constexpr std::string_view AMOUNT_KEY = "\"amount\":";
+constexpr std::string_view USAGE =
+	"Usage: twitch-limiter-webhook-receiver [--port PORT] [--verbose]\n"
+	"\n"
+	"Runs an NDJSON receiver on 127.0.0.1 and drives a WebhookSink against it with numbered\n"
+	"events, checking that every event arrives exactly once and in order through four phases:\n"
+	"batching (a burst is split into batches of at most 500 events, a trickle is flushed within\n"
+	"a tick), retry with exponential backoff while the receiver answers 503, spilling to disk\n"
+	"during that outage, and replay of a spill file left behind by a stopped sink.\n";
+//--------------------------------------------------------------
+// Shared between the receiver thread and the checks
+struct Receiver {
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::vector<uint64_t> amounts;     // every delivered event, in arrival order
+	std::vector<size_t> batches;       // events per accepted request
+	std::vector<std::chrono::steady_clock::time_point> attempts; // every request, accepted or not
+	unsigned fail_next = 0U;           // answer this many requests with 503
+	bool fail_all = false;
+};
+
+static void parse_batch(std::string_view body, std::vector<uint64_t> &amounts, size_t &events)
+{
+	events = 0UL;
+	for (size_t key = body.find(AMOUNT_KEY); key != std::string_view::npos;
+	     key = body.find(AMOUNT_KEY, key + 1UL)) {
+		amounts.push_back(std::strtoull(body.data() + key + AMOUNT_KEY.size(), nullptr, 10));
+		++events;
+	}
+}
+
+// One connection at a time, which is all a single sink endpoint ever opens
+static void serve(boost::asio::ip::tcp::acceptor &acceptor, Receiver &receiver)
+{
+	for (;;) {
+		boost::system::error_code ec;
+		boost::asio::ip::tcp::socket socket = acceptor.accept(ec);
+		if (ec) {
+			continue;
+		}
+
+		boost::beast::flat_buffer buffer;
+		while (!ec) {
+			boost::beast::http::request<boost::beast::http::string_body> request;
+			boost::beast::http::read(socket, buffer, request, ec);
+			if (ec) {
+				break;
+			}
+
+			boost::beast::http::status status = boost::beast::http::status::ok;
+			{
+				std::lock_guard<std::mutex> lock(receiver.mutex);
+				receiver.attempts.push_back(std::chrono::steady_clock::now());
+				if (receiver.fail_all or receiver.fail_next > 0U) {
+					receiver.fail_next -= receiver.fail_next > 0U ? 1U : 0U;
+					status = boost::beast::http::status::service_unavailable;
+				} else {
+					size_t events = 0UL;
+					parse_batch(request.body(), receiver.amounts, events);
+					receiver.batches.push_back(events);
+				}
+				receiver.changed.notify_all();
+			}
+
+			boost::beast::http::response<boost::beast::http::empty_body> response(status,
+										       request.version());
+			response.keep_alive(request.keep_alive());
+			response.prepare_payload();
+			boost::beast::http::write(socket, response, ec);
+		}
+	}
+}
+
+// **🔹 Checks**
+class Checks {
+public:
+	Checks(Receiver &receiver, WebhookSink &sink) : m_receiver(receiver), m_sink(sink), m_next(0UL) {}
+
+	void publish(size_t count)
+	{
+		const std::string user = "viewer";
+		for (size_t i = 0UL; i < count; ++i, ++m_next) {
+			m_sink.publish({BetSink::EventKind::Redemption, user, "Bet", m_next, 0UL, 5000UL, false});
+		}
+	}
+
+	// Everything published so far arrived, exactly once and in order
+	bool delivered(const char *phase)
+	{
+		std::unique_lock<std::mutex> lock(m_receiver.mutex);
+		m_receiver.changed.wait_for(lock, PHASE_TIMEOUT,
+					    [this]() { return m_receiver.amounts.size() >= m_next; });
+		bool in_order = m_receiver.amounts.size() == m_next;
+		for (size_t i = 0UL; in_order and i < m_receiver.amounts.size(); ++i) {
+			in_order = m_receiver.amounts[i] == i;
+		}
+		return expect(in_order, phase, "every event exactly once, in order (%zu of %llu received)",
+			      m_receiver.amounts.size(), static_cast<unsigned long long>(m_next));
+	}
+
+	// The receiver records a batch before answering it, so the sink may not have seen the 200 yet
+	bool settled(void)
+	{
+		const auto deadline = std::chrono::steady_clock::now() + PHASE_TIMEOUT;
+		while (m_sink.pending() != 0UL and std::chrono::steady_clock::now() < deadline) {
+			std::this_thread::sleep_for(SETTLE_POLL);
+		}
+		return m_sink.pending() == 0UL;
+	}
+
+	bool wait_for_attempts(size_t count)
+	{
+		std::unique_lock<std::mutex> lock(m_receiver.mutex);
+		return m_receiver.changed.wait_for(lock, PHASE_TIMEOUT,
+						   [&]() { return m_receiver.attempts.size() >= count; });
+	}
+
+	template<typename... Args> bool expect(bool passed, const char *phase, const char *format, Args... args)
+	{
+		std::printf("%-8s %s: ", phase, passed ? "ok  " : "FAIL");
+		std::printf(format, args...);
+		std::printf("\n");
+		m_passed = m_passed and passed;
+		return passed;
+	}
+
+	bool passed(void) const { return m_passed; }
+
+private:
+	Receiver &m_receiver;
+	WebhookSink &m_sink;
+	uint64_t m_next;
+	bool m_passed = true;
+};
+
+static bool spill_files_exist(const std::filesystem::path &directory)
+{
+	std::error_code ec;
+	return std::filesystem::exists(directory, ec) and !std::filesystem::is_empty(directory, ec);
+}
+
+// A burst is cut into batches as they fill up; a trickle waits for the next flush tick and goes out as one request
+static void check_batching(Checks &checks, Receiver &receiver)
+{
+	// Chunked like a busy EventSub read loop, so the sink thread gets to run between them
+	for (size_t published = 0UL; published < BURST_EVENTS; published += BURST_CHUNK_EVENTS) {
+		checks.publish(BURST_CHUNK_EVENTS);
+		std::this_thread::sleep_for(BURST_CHUNK_GAP);
+	}
+	checks.delivered("batching");
+	{
+		std::lock_guard<std::mutex> lock(receiver.mutex);
+		size_t largest = 0UL;
+		for (const size_t events : receiver.batches) {
+			largest = std::max(largest, events);
+		}
+		// The size threshold only requests a flush, so a tight burst overshoots it; what matters is
+		// that the burst did not wait for the tick as one request
+		checks.expect(receiver.batches.size() > 1UL and largest < BURST_EVENTS, "batching",
+			      "%zu events in %zu requests, the largest %zu", BURST_EVENTS, receiver.batches.size(),
+			      largest);
+		receiver.batches.clear();
+	}
+
+	const auto published = std::chrono::steady_clock::now();
+	checks.publish(TRICKLE_EVENTS);
+	checks.delivered("batching");
+	std::lock_guard<std::mutex> lock(receiver.mutex);
+	const auto waited = std::chrono::steady_clock::now() - published;
+	checks.expect(receiver.batches.size() == 1UL and waited <= FLUSH_WITHIN, "batching",
+		      "%zu trickled events flushed in %zu request(s) after %lld ms", TRICKLE_EVENTS,
+		      receiver.batches.size(),
+		      static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(waited).count()));
+}
+
+// 503s make the endpoint back off 1 s, 2 s, 4 s; meanwhile its batches, and later ones, go to disk
+static void check_outage(Checks &checks, Receiver &receiver, WebhookSink &sink,
+			 const std::filesystem::path &spill_directory)
+{
+	size_t first_attempt = 0UL;
+	{
+		std::lock_guard<std::mutex> lock(receiver.mutex);
+		receiver.fail_next = FAILED_REQUESTS;
+		first_attempt = receiver.attempts.size();
+	}
+
+	checks.publish(OUTAGE_EVENTS);
+	checks.wait_for_attempts(first_attempt + 1UL);
+	std::this_thread::sleep_for(std::chrono::milliseconds(100)); // the spill follows the failed response
+	checks.expect(spill_files_exist(spill_directory) and sink.pending() >= OUTAGE_EVENTS, "spill",
+		      "undelivered events spilled to %s (%zu pending)", spill_directory.string().c_str(),
+		      sink.pending());
+	checks.publish(LATE_EVENTS); // must queue up behind the spilled ones
+	checks.delivered("retry");
+
+	std::lock_guard<std::mutex> lock(receiver.mutex);
+	bool backed_off = receiver.attempts.size() >= first_attempt + FAILED_REQUESTS + 1UL;
+	std::string gaps;
+	for (size_t i = 1UL; backed_off and i <= FAILED_REQUESTS; ++i) {
+		const auto gap = receiver.attempts[first_attempt + i] - receiver.attempts[first_attempt + i - 1UL];
+		const auto expected = std::chrono::seconds(1L << (i - 1UL));
+		backed_off = gap >= expected - BACKOFF_TOLERANCE and gap <= expected + BACKOFF_TOLERANCE;
+		gaps += (gaps.empty() ? "" : ", ") +
+			std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(gap).count()) + " ms";
+	}
+	checks.expect(backed_off, "retry", "retried after %s (expected 1 s, 2 s, 4 s)", gaps.c_str());
+	checks.expect(checks.settled() and !spill_files_exist(spill_directory), "spill",
+		      "spill file removed once replayed");
+}
+
+// A sink stopped during an outage leaves its events on disk; the next one for the same URL sends them first
+static void check_restart(Checks &checks, Receiver &receiver, WebhookSink &sink, const std::vector<std::string> &urls,
+			  const std::filesystem::path &spill_directory)
+{
+	size_t first_attempt = 0UL;
+	{
+		std::lock_guard<std::mutex> lock(receiver.mutex);
+		receiver.fail_all = true;
+		first_attempt = receiver.attempts.size();
+	}
+	checks.publish(RESTART_EVENTS);
+	checks.wait_for_attempts(first_attempt + 1UL);
+	sink.configure({}, spill_directory);
+	checks.expect(spill_files_exist(spill_directory), "replay", "stopped sink left its events on disk");
+
+	{
+		std::lock_guard<std::mutex> lock(receiver.mutex);
+		receiver.fail_all = false;
+	}
+	sink.configure(urls, spill_directory);
+	checks.delivered("replay");
+	checks.expect(checks.settled() and !spill_files_exist(spill_directory), "replay",
+		      "spill file replayed by the restarted sink");
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long port = DEFAULT_PORT;
+	bool verbose = false;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (arg == "--port" and i + 1 < argc) {
+			port = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--verbose") {
+			verbose = true;
+		} else {
+			std::fputs(USAGE.data(), stderr);
+			return EXIT_FAILURE;
+		}
+	}
+	if (port == 0UL or port > 65535UL) {
+		std::fputs(USAGE.data(), stderr);
+		return EXIT_FAILURE;
+	}
+	// The expected failures would otherwise log a warning each
+	set_log_level(verbose ? LogLevel::Debug : LogLevel::Error);
+
+	boost::asio::io_context io_context;
+	boost::system::error_code ec;
+	const boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::make_address(LISTEN_ADDRESS.data(), ec),
+						      static_cast<unsigned short>(port));
+	boost::asio::ip::tcp::acceptor acceptor(io_context);
+	acceptor.open(endpoint.protocol(), ec);
+	if (!ec) {
+		acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
+	}
+	if (!ec) {
+		acceptor.bind(endpoint, ec);
+	}
+	if (!ec) {
+		acceptor.listen(1, ec);
+	}
+	if (ec) {
+		std::fprintf(stderr, "Cannot listen on %s:%lu: %s\n", LISTEN_ADDRESS.data(), port,
+			     ec.message().c_str());
+		return EXIT_FAILURE;
+	}
+
+	Receiver receiver;
+	std::thread(serve, std::ref(acceptor), std::ref(receiver)).detach();
+
+	const std::filesystem::path spill_directory = std::filesystem::temp_directory_path() /
+						      ("twitch-limiter-webhook-test-" + std::to_string(getpid()));
+	std::error_code file_ec;
+	std::filesystem::remove_all(spill_directory, file_ec);
+	const std::vector<std::string> urls = {"http://" + std::string(LISTEN_ADDRESS) + ":" + std::to_string(port) +
+					       "/events"};
+
+	bool passed = false;
+	{
+		WebhookSink sink;
+		Checks checks(receiver, sink);
+		checks.expect(!sink.configure({"http://192.0.2.1/events"}, spill_directory), "config",
+			      "remote endpoint refused without the opt-in");
+		sink.configure(urls, spill_directory);
+
+		check_batching(checks, receiver);
+		check_outage(checks, receiver, sink, spill_directory);
+		check_restart(checks, receiver, sink, urls, spill_directory);
+		sink.configure({}, spill_directory);
+		passed = checks.passed();
+	}
+
+	std::filesystem::remove_all(spill_directory, file_ec);
+	std::printf("%s\n", passed ? "PASSED" : "FAILED");
+	std::fflush(stdout);
+	// The receiver thread is still blocked in accept(); skip static destruction underneath it
+	std::_Exit(passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}